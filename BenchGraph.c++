@@ -0,0 +1,364 @@
+// -----------------------------
+// projects/graph/BenchGraph.c++
+// Copyright (C) 2014
+// Glenn P. Downing
+// -----------------------------
+
+/*
+Times the graph types that TestGraph.c++ checks against each other on generated
+R-MAT, uniform-random and star graphs of several sizes, and writes one CSV row per
+(shape, size, type) case:
+    shape,type,scale,vertices,edges,build_s,lookup_s,edges_s,adjacency_s,hits,checksum,base_kb,peak_kb
+
+    build_s     add_vertex for every vertex, then add_edge for every generated pair
+                (CompactGraph: freeze a Graph built before base_kb is sampled)
+    lookup_s    edge() on every generated pair and as many random pairs
+    edges_s     one sweep over edges(), reading each target
+    adjacency_s one sweep over adjacent_vertices() of every vertex
+    hits        how many lookups found an edge; the same for every type
+    checksum    sum of the sweeps' targets; the same for every type
+    base_kb     peak RSS before the graph was built, with the input already generated
+                (CompactGraph: and the Graph to freeze, so peak_kb - base_kb is the
+                frozen graph alone)
+    peak_kb     peak RSS after the last sweep
+
+Every case runs in a forked child, so peak RSS belongs to that case alone.
+
+To compile:
+    % g++-4.7 -O2 -DNDEBUG -pedantic -std=c++11 -Wall BenchGraph.c++ -o BenchGraph -lpthread
+
+To run:
+    % BenchGraph [output.csv [max_scale]]
+    writes BenchGraph.csv with graphs of 2^10 up to 2^max_scale vertices, 2^18 by default
+    exits with 1 if a case fails or writes a row whose field count does not match the header
+*/
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // count
+#include <chrono>    // steady_clock
+#include <cstddef>   // ptrdiff_t
+#include <cstdint>   // uint64_t
+#include <cstdlib>   // atoi
+#include <fstream>   // ofstream
+#include <iostream>  // cerr, cout, endl
+#include <sstream>   // ostringstream
+#include <string>    // string
+#include <utility>   // make_pair, pair
+#include <vector>    // vector
+
+#include <sys/resource.h> // getrusage
+#include <sys/wait.h>     // waitpid
+#include <unistd.h>       // close, fork, pipe, read, write
+
+#include "Graph.h"
+#include "GraphTypes.h"
+
+// ----------
+// graph_name
+// ----------
+
+template <typename G> struct graph_name;
+template <> struct graph_name<boost_graph>  {static const char *get () {return "boost::adjacency_list";}};
+template <> struct graph_name<Graph>        {static const char *get () {return "Graph";}};
+template <> struct graph_name<slim_graph>   {static const char *get () {return "slim_graph";}};
+template <> struct graph_name<CompactGraph> {static const char *get () {return "CompactGraph";}};
+
+// ----------
+// generators
+// ----------
+
+typedef std::vector< std::pair<std::size_t, std::size_t> > edge_vector;
+
+/**
+ * xorshift64*, so every run and every type sees the same graphs
+ */
+struct random_bits {
+    std::uint64_t state;
+
+    explicit random_bits (std::uint64_t seed) :
+        state(seed * 2 + 1)
+    {}
+
+    std::uint64_t next () {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 2685821657736338717ull;
+    }
+
+    double unit () {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+};
+
+/**
+ * Recursive-matrix graph (Chakrabarti, Zhan and Faloutsos) with the Graph500
+ * quadrant probabilities, giving a skewed, power-law degree distribution.
+ */
+edge_vector rmat (std::size_t scale, std::size_t degree, random_bits& r) {
+    edge_vector e;
+    e.reserve(degree << scale);
+    for(std::size_t i = 0; i < (degree << scale); ++i) {
+        std::size_t u = 0;
+        std::size_t v = 0;
+        for(std::size_t bit = 0; bit < scale; ++bit) {
+            const double p = r.unit();
+            u = (u << 1) | (p >= 0.57 + 0.19);
+            v = (v << 1) | (p >= 0.57 && (p < 0.57 + 0.19 || p >= 0.57 + 0.19 + 0.19));
+        }
+        e.push_back(std::make_pair(u, v));
+    }
+    return e;
+}
+
+/**
+ * Every edge joins two vertices chosen uniformly at random.
+ */
+edge_vector uniform (std::size_t scale, std::size_t degree, random_bits& r) {
+    edge_vector e;
+    e.reserve(degree << scale);
+    for(std::size_t i = 0; i < (degree << scale); ++i)
+        e.push_back(std::make_pair(r.next() % (std::size_t(1) << scale), r.next() % (std::size_t(1) << scale)));
+    return e;
+}
+
+/**
+ * Vertex 0 has an edge to and from every other vertex, the worst case for a
+ * per-vertex edge scan.
+ */
+edge_vector star (std::size_t scale, std::size_t, random_bits&) {
+    edge_vector e;
+    for(std::size_t v = 1; v < (std::size_t(1) << scale); ++v) {
+        e.push_back(std::make_pair(std::size_t(0), v));
+        e.push_back(std::make_pair(v, std::size_t(0)));
+    }
+    return e;
+}
+
+// ----------
+// bench_case
+// ----------
+
+struct bench_case {
+    const char   *shape;
+    edge_vector (*generate) (std::size_t, std::size_t, random_bits&);
+    std::size_t   scale;
+    std::size_t   degree;
+};
+
+// -------
+// builder
+// -------
+
+/**
+ * adds n vertices to g, then every pair of e as an edge
+ */
+template <typename G>
+void add_all (G& g, std::size_t n, const edge_vector& e) {
+    for(std::size_t v = 0; v < n; ++v)
+        add_vertex(g);
+    for(std::size_t i = 0; i < e.size(); ++i)
+        add_edge(e[i].first, e[i].second, g);
+}
+
+/**
+ * Builds a G from the generated edges. run_case makes the prepared input
+ * before it samples base_kb, so that only build itself counts towards peak_kb.
+ */
+template <typename G>
+struct builder {
+    struct prepared {
+        prepared (std::size_t, const edge_vector&) {}
+    };
+
+    static void build (G& g, prepared&, std::size_t n, const edge_vector& e) {
+        add_all(g, n, e);
+    }
+};
+
+// CompactGraph::add_edge is O(V + E); freezing is how CompactGraphs get built
+template <>
+struct builder<CompactGraph> {
+    struct prepared {
+        Graph g;
+
+        prepared (std::size_t n, const edge_vector& e) {
+            add_all(g, n, e);
+        }
+    };
+
+    static void build (CompactGraph& c, prepared& p, std::size_t, const edge_vector&) {
+        c = freeze(p.g);
+    }
+};
+
+// --------
+// run_case
+// --------
+
+/**
+ * @returns the peak resident set size of this process so far, in KB
+ */
+long peak_kb () {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/**
+ * @returns the seconds since start
+ */
+double since (std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Generates the graph of c, builds it as a G and times the four phases.
+ * @returns one CSV row
+ */
+template <typename G>
+std::string run_case (const bench_case& c) {
+    random_bits       r(c.scale);
+    const std::size_t n = std::size_t(1) << c.scale;
+    const edge_vector e = c.generate(c.scale, c.degree, r);
+    edge_vector       queries(e);
+    for(std::size_t i = 0; i < e.size(); ++i)
+        queries.push_back(std::make_pair(r.next() % n, r.next() % n));
+    typename builder<G>::prepared input(n, e);
+    const long base = peak_kb();
+
+    G g;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    builder<G>::build(g, input, n, e);
+    const double build_s = since(start);
+
+    std::size_t hits = 0;
+    start = std::chrono::steady_clock::now();
+    for(std::size_t i = 0; i < queries.size(); ++i)
+        hits += edge(queries[i].first, queries[i].second, g).second;
+    const double lookup_s = since(start);
+
+    std::size_t checksum = 0;
+    start = std::chrono::steady_clock::now();
+    std::pair<typename G::edge_iterator, typename G::edge_iterator> p = edges(g);
+    for(; p.first != p.second; ++p.first)
+        checksum += target(*p.first, g);
+    const double edges_s = since(start);
+
+    start = std::chrono::steady_clock::now();
+    std::pair<typename G::vertex_iterator, typename G::vertex_iterator> v = vertices(g);
+    for(; v.first != v.second; ++v.first) {
+        std::pair<typename G::adjacency_iterator, typename G::adjacency_iterator> a = adjacent_vertices(*v.first, g);
+        for(; a.first != a.second; ++a.first)
+            checksum += *a.first;
+    }
+    const double adjacency_s = since(start);
+
+    std::ostringstream row;
+    row << c.shape << ',' << graph_name<G>::get() << ',' << c.scale << ','
+        << num_vertices(g) << ',' << num_edges(g) << ','
+        << build_s << ',' << lookup_s << ',' << edges_s << ',' << adjacency_s << ','
+        << hits << ',' << checksum << ',' << base << ',' << peak_kb() << '\n';
+    return row.str();
+}
+
+// -------
+// measure
+// -------
+
+const char header[] = "shape,type,scale,vertices,edges,build_s,lookup_s,edges_s,adjacency_s,hits,checksum,base_kb,peak_kb\n";
+
+/**
+ * Writes row to out and to cout.
+ * @returns false, after saying why, if row does not have a field for every column of header
+ */
+bool write_row (std::ostream& out, const std::string& row) {
+    out << row;
+    std::cout << row << std::flush;
+    const std::ptrdiff_t columns = std::count(header, header + sizeof(header) - 1, ',') + 1;
+    const std::ptrdiff_t fields  = std::count(row.begin(), row.end(), ',') + 1;
+    if(fields == columns)
+        return true;
+    std::cerr << "BenchGraph: row has " << fields << " fields for " << columns << " columns" << std::endl;
+    return false;
+}
+
+/**
+ * Runs c on a G in a forked child and writes its row to out; runs it in this
+ * process if fork fails.
+ * @returns false if the case failed or its row does not match the header
+ */
+template <typename G>
+bool measure (std::ostream& out, const bench_case& c) {
+    int fd[2];
+    if(pipe(fd) == 0) {
+        const pid_t pid = fork();
+        if(pid == 0) {
+            close(fd[0]);
+            const std::string row = run_case<G>(c);
+            const ssize_t written = write(fd[1], row.data(), row.size());
+            _exit(written == ssize_t(row.size()) ? 0 : 1);
+        }
+        close(fd[1]);
+        if(pid > 0) {
+            std::string row;
+            char        buffer[256];
+            for(ssize_t k; (k = read(fd[0], buffer, sizeof(buffer))) > 0; )
+                row.append(buffer, k);
+            close(fd[0]);
+            int status = 0;
+            waitpid(pid, &status, 0);
+            if(!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                std::cerr << "BenchGraph: " << c.shape << " 2^" << c.scale << ' ' << graph_name<G>::get() << " failed" << std::endl;
+                return false;
+            }
+            return write_row(out, row);
+        }
+        close(fd[0]);
+    }
+    return write_row(out, run_case<G>(c));
+}
+
+inline bool measure_all (std::ostream&, const bench_case&, graph_list<>) {
+    return true;
+}
+
+template <typename G, typename... Gs>
+bool measure_all (std::ostream& out, const bench_case& c, graph_list<G, Gs...>) {
+    const bool ok = measure<G>(out, c);
+    return measure_all(out, c, graph_list<Gs...>()) && ok;
+}
+
+// ----
+// main
+// ----
+
+int main (int argc, char *argv[]) {
+    const std::string path      = argc > 1 ? argv[1] : "BenchGraph.csv";
+    const std::size_t max_scale = argc > 2 ? std::atoi(argv[2]) : 18;
+
+    std::ofstream out(path.c_str());
+    if(!out) {
+        std::cerr << "BenchGraph: cannot write " << path << std::endl;
+        return 1;
+    }
+    out << header;
+    std::cout << header;
+
+    const bench_case shapes[] = {
+        {"rmat",    rmat,    0, 8},
+        {"uniform", uniform, 0, 8},
+        {"star",    star,    0, 0}};
+    bool ok = true;
+    for(std::size_t scale = 10; scale <= max_scale; scale += 4) {
+        for(std::size_t i = 0; i < sizeof(shapes) / sizeof(shapes[0]); ++i) {
+            bench_case c = shapes[i];
+            c.scale = scale;
+            ok = measure_all(out, c, graph_types()) && ok;
+        }
+    }
+    return ok && out ? 0 : 1;
+}
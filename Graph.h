@@ -11,27 +11,3653 @@
 // includes
 // --------
 
-#include <cassert> // assert
-#include <cstddef> // size_t
-#include <utility> // make_pair, pair
-#include <vector>  // vector
+#include <algorithm>     // copy, find, is_sorted, lower_bound, max, min, remove, reverse, sort, stable_sort, unique, upper_bound
+#include <atomic>        // atomic
+#include <cassert>       // assert
+#include <chrono>        // steady_clock
+#include <cstddef>       // size_t
+#include <cstdint>       // uint16_t, uint32_t, uint64_t
+#include <cstring>       // memchr, memcmp, memcpy
+#include <fstream>       // ofstream
+#include <limits>        // numeric_limits
+#include <map>           // map
+#include <memory>        // shared_ptr
+#include <mutex>         // lock_guard, mutex
+#include <stdexcept>     // invalid_argument, runtime_error
+#include <string>        // string
+#include <thread>        // thread
+#include <type_traits>   // conditional, integral_constant
+#include <unordered_map> // unordered_map
+#include <utility>       // make_pair, pair
+#include <vector>        // vector
 
-// -----
-// Graph
-// -----
+#include <fcntl.h>       // open
+#include <sys/mman.h>    // madvise, mmap, munmap
+#include <sys/stat.h>    // fstat
+#include <unistd.h>      // close
 
-class Graph {
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#include <immintrin.h>   // _mm_*, _mm256_*
+#define GRAPH_X86_KERNELS
+#endif
+
+class CompactGraph;
+
+template <typename Descriptor = std::size_t, bool EdgeList = true>
+class basic_graph;
+
+template <typename Descriptor = std::size_t, bool EdgeList = true>
+class concurrent_builder;
+
+template <typename Descriptor = std::size_t>
+class versioned_graph;
+
+template <typename Descriptor = std::size_t>
+class graph_snapshot;
+
+/**
+ * the vertex orders reorder can relabel a graph into
+ */
+enum reorder_strategy {
+    degree_descending,      //highest total degree first, ties by descriptor
+    reverse_cuthill_mckee,  //small bandwidth: reversed BFS from low degree starts, low degree neighbours first
+    breadth_first};         //BFS from the lowest unvisited descriptor, neighbours in adjacency order
+
+// ------------
+// graph_detail
+// ------------
+
+namespace graph_detail {
+
+    // ------------
+    // thread_count
+    // ------------
+
+    /**
+     * @param n     the number of items of work
+     * @param grain the minimum number of items worth a thread
+     * @returns     how many threads to split n items across, at least 1
+     */
+    inline std::size_t thread_count (std::size_t n, std::size_t grain) {
+        std::size_t t = std::thread::hardware_concurrency();
+        if(t > n / grain)
+            t = n / grain;
+        return t == 0 ? 1 : t;
+    }
+
+    // -------------
+    // parallel_for
+    // -------------
+
+    /**
+     * Splits [0, n) into contiguous chunks and runs f(begin, end) on each chunk,
+     * one chunk per hardware thread; small ranges run on the calling thread.
+     * @param n     the number of items
+     * @param f     the function to run on each chunk
+     * @param grain the minimum number of items worth a thread
+     */
+    template <typename F>
+    void parallel_for (std::size_t n, F f, std::size_t grain = 4096) {
+        const std::size_t t = thread_count(n, grain);
+        if(t == 1) {
+            f(std::size_t(0), n);
+            return;
+        }
+
+        std::vector<std::thread> workers;
+        workers.reserve(t - 1);
+        for(std::size_t i = 1; i < t; ++i)
+            workers.push_back(std::thread(f, n * i / t, n * (i + 1) / t));
+        f(std::size_t(0), n / t);
+        for(std::size_t i = 0; i < workers.size(); ++i)
+            workers[i].join();
+    }
+
+    // -------------
+    // parallel_sort
+    // -------------
+
+    /**
+     * Sorts [first, last) by sorting chunks in parallel and then merging
+     * neighbouring runs pairwise, also in parallel.
+     * @param first the beginning of the range
+     * @param last  the end of the range
+     * @param comp  the strict weak ordering to sort by
+     */
+    template <typename RI, typename Compare>
+    void parallel_sort (RI first, RI last, Compare comp) {
+        const std::size_t n = last - first;
+        const std::size_t t = thread_count(n, 4096);
+        parallel_for(n, [&] (std::size_t b, std::size_t e) {
+            std::sort(first + b, first + e, comp);
+        });
+        if(t == 1)
+            return;
+
+        // parallel_for used the same t chunks, so these are the sorted runs
+        std::vector<std::size_t> bounds(1, 0);
+        for(std::size_t i = 1; i <= t; ++i)
+            bounds.push_back(n * i / t);
+
+        while(bounds.size() > 2) {
+            const std::size_t runs = (bounds.size() - 1) / 2;
+            std::vector<std::thread> workers;
+            for(std::size_t i = 0; i < runs; ++i) {
+                RI b = first + bounds[2 * i];
+                RI m = first + bounds[2 * i + 1];
+                RI e = first + bounds[2 * i + 2];
+                workers.push_back(std::thread([b, m, e, &comp] () {
+                    std::inplace_merge(b, m, e, comp);
+                }));
+            }
+            for(std::size_t i = 0; i < workers.size(); ++i)
+                workers[i].join();
+
+            std::vector<std::size_t> merged;
+            for(std::size_t i = 0; i < bounds.size(); i += 2)
+                merged.push_back(bounds[i]);
+            if(merged.back() != bounds.back())
+                merged.push_back(bounds.back());
+            bounds.swap(merged);
+        }
+    }
+
+    // ---------------
+    // segmented_array
+    // ---------------
+
+    /**
+     * An array that grows without ever moving its elements, so other threads can
+     * keep using them while it grows. Segment k holds first << k elements, and a
+     * segment is allocated by whichever thread first needs it.
+     */
+    template <typename T>
+    class segmented_array {
+      private:
+        static const std::size_t first    = 1024;
+        static const std::size_t segments = 40;
+
+        std::atomic<T*> _segments[segments];
+
+        static std::size_t segment (std::size_t i) {
+            return 63 - __builtin_clzll(static_cast<unsigned long long>(i / first + 1));
+        }
+
+        static std::size_t offset (std::size_t i, std::size_t k) {
+            return i - first * ((std::size_t(1) << k) - 1);
+        }
+
+      public:
+        segmented_array () {
+            for(std::size_t k = 0; k < segments; ++k)
+                _segments[k].store(0, std::memory_order_relaxed);
+        }
+
+        ~segmented_array () {
+            clear();
+        }
+
+        /**
+         * makes sure element i exists; safe from several threads
+         */
+        void ensure (std::size_t i) {
+            const std::size_t k = segment(i);
+            if(_segments[k].load(std::memory_order_acquire) != 0)
+                return;
+            T *fresh    = new T[first << k];
+            T *expected = 0;
+            if(!_segments[k].compare_exchange_strong(expected, fresh, std::memory_order_acq_rel))
+                delete[] fresh;
+        }
+
+        /**
+         * @param i an index that ensure has been called on
+         * @returns element i
+         */
+        T& operator [] (std::size_t i) {
+            const std::size_t k = segment(i);
+            return _segments[k].load(std::memory_order_acquire)[offset(i, k)];
+        }
+
+        /**
+         * frees every segment; not safe alongside other calls
+         */
+        void clear () {
+            for(std::size_t k = 0; k < segments; ++k)
+                delete[] _segments[k].exchange(0, std::memory_order_relaxed);
+        }
+
+      private:
+        segmented_array (const segmented_array&);
+        segmented_array& operator = (const segmented_array&);
+    };
+
+    // ----------
+    // append_row
+    // ----------
+
+    /**
+     * An adjacency row that only grows and never moves what it holds: entries go
+     * into a chain of chunks, each twice the size of the one before. One writer at
+     * a time appends; any number of readers may walk the first size entries, with
+     * no lock, while it does.
+     */
+    template <typename Descriptor>
+    struct append_row {
+        struct entry {
+            Descriptor edge_no;
+            Descriptor target;
+        };
+
+        struct chunk {
+            entry       *entries;
+            std::size_t  capacity;
+            chunk       *next;
+        };
+
+        std::atomic<std::size_t> size;          //entries published to readers
+        chunk                   *first;         //set before the first entry is published
+        chunk                   *last;          //writer only
+        std::size_t              last_start;    //writer only: the index of last's first entry
+
+        append_row () :
+            first(0),
+            last(0),
+            last_start(0) {
+            size.store(0, std::memory_order_relaxed);
+        }
+
+        ~append_row () {
+            while(first != 0) {
+                chunk *next = first->next;
+                delete[] first->entries;
+                delete first;
+                first = next;
+            }
+        }
+
+        /**
+         * appends e and then publishes it
+         */
+        void push_back (const entry& e) {
+            const std::size_t n = size.load(std::memory_order_relaxed);
+            if(last == 0 || n == last_start + last->capacity) {
+                chunk *c    = new chunk;
+                c->capacity = last == 0 ? 4 : 2 * last->capacity;
+                c->entries  = new entry[c->capacity];
+                c->next     = 0;
+                if(last == 0)
+                    first = c;
+                else {
+                    last_start += last->capacity;
+                    last->next  = c;
+                }
+                last = c;
+            }
+            last->entries[n - last_start] = e;
+            size.store(n + 1, std::memory_order_release);
+        }
+
+      private:
+        append_row (const append_row&);
+        append_row& operator = (const append_row&);
+    };
+
+    // -----------
+    // mapped_file
+    // -----------
+
+    /**
+     * A read-only mapping of a whole file, unmapped on destruction.
+     */
+    struct mapped_file {
+        void        *base;
+        std::size_t  length;
+
+        /**
+         * maps path, leaving base at MAP_FAILED if the file is empty
+         * @param   path    the file to map
+         * @param   who     the caller, for error messages
+         * @throws  std::runtime_error if the file cannot be opened or mapped
+         */
+        mapped_file (const std::string& path, const char *who) :
+            base(MAP_FAILED),
+            length(0)
+        {
+            const int fd = open(path.c_str(), O_RDONLY);
+            if(fd < 0)
+                throw std::runtime_error(std::string(who) + ": cannot open " + path);
+            struct stat st;
+            if(fstat(fd, &st) == 0) {
+                length = st.st_size;
+                if(length != 0)
+                    base = mmap(0, length, PROT_READ, MAP_SHARED, fd, 0);
+            }
+            close(fd);
+            if(length != 0 && base == MAP_FAILED)
+                throw std::runtime_error(std::string(who) + ": cannot map " + path);
+        }
+
+        ~mapped_file () {
+            if(base != MAP_FAILED)
+                munmap(base, length);
+        }
+
+        /**
+         * @returns the first byte of the file
+         */
+        const char* data () const {
+            return static_cast<const char*>(base);
+        }
+
+      private:
+        mapped_file (const mapped_file&);
+        mapped_file& operator = (const mapped_file&);
+    };
+
+    // ------------
+    // mapped_graph
+    // ------------
+
+    /**
+     * A mapped graph file written by save_graph.
+     * The pointers refer straight into the mapped pages; the mapping is released
+     * when the last CompactGraph sharing it goes away.
+     */
+    struct mapped_graph : mapped_file {
+        std::size_t        vertices;
+        std::size_t        edges;
+        const std::size_t *offsets;
+        const std::size_t *targets;
+        const std::size_t *edge_ids;
+        const std::size_t *slots;
+
+        explicit mapped_graph (const std::string& path) :
+            mapped_file(path, "map_graph")
+        {}
+    };
+
+    // ------------
+    // graph_header
+    // ------------
+
+    /**
+     * The fixed-size header at the start of a graph file. It is followed by the
+     * offsets (vertices + 1 words), targets, edge_ids and slots (edges words each)
+     * arrays of a CompactGraph, in native byte order.
+     */
+    struct graph_header {
+        char          magic[8];  //"CSRGRAPH"
+        std::uint32_t version;   //graph_version
+        std::uint16_t word_size; //sizeof(std::size_t) of the writer
+        std::uint16_t byte_order;//0x0102 as written by the writer
+        std::uint64_t vertices;
+        std::uint64_t edges;
+    };
+
+    static const std::uint32_t graph_version = 2; //2: rows sorted by target
+
+    // ----------------
+    // parse_edge_lines
+    // ----------------
+
+    /**
+     * Parses the edge lines in [b, e) into consecutive (source id, target id) values.
+     * Lines starting with # or % are comments. Each id must end in whitespace or
+     * the end of the text; anything after the second id on a line, such as a
+     * weight, is ignored.
+     * @param   b   the first byte, at the start of a line
+     * @param   e   one past the last byte, at the end of a line
+     * @param   out where the ids are appended
+     * @returns     false if a line does not start with two whitespace-separated
+     *              unsigned integers that fit in 64 bits
+     */
+    inline bool parse_edge_lines (const char *b, const char *e, std::vector<std::uint64_t>& out) {
+        while(b != e) {
+            if(*b == ' ' || *b == '\t' || *b == '\r' || *b == '\n') {
+                ++b;
+                continue;
+            }
+            if(*b != '#' && *b != '%') {
+                for(int k = 0; k < 2; ++k) {
+                    while(b != e && (*b == ' ' || *b == '\t'))
+                        ++b;
+                    if(b == e || *b < '0' || *b > '9')
+                        return false;
+                    std::uint64_t id = 0;
+                    do {
+                        const unsigned digit = *b - '0';
+                        if(id > (std::numeric_limits<std::uint64_t>::max() - digit) / 10)
+                            return false;
+                        id = 10 * id + digit;
+                    } while(++b != e && *b >= '0' && *b <= '9');
+                    if(b != e && *b != ' ' && *b != '\t' && *b != '\r' && *b != '\n')
+                        return false;
+                    out.push_back(id);
+                }
+            }
+            const char *eol = static_cast<const char*>(std::memchr(b, '\n', e - b));
+            b = eol ? eol + 1 : e;
+        }
+        return true;
+    }
+
+    // ---
+    // csr
+    // ---
+
+    /**
+     * Plain compressed sparse row adjacency that the algorithms below run on:
+     * the neighbours of v are targets[offsets[v]] up to targets[offsets[v + 1]].
+     */
+    struct csr {
+        std::vector<std::size_t> offsets;
+        std::vector<std::size_t> targets;
+
+        /**
+         * @returns the number of vertices
+         */
+        std::size_t size () const {
+            return offsets.size() - 1;
+        }
+
+        /**
+         * @returns the number of neighbours of v
+         */
+        std::size_t degree (std::size_t v) const {
+            return offsets[v + 1] - offsets[v];
+        }
+    };
+
+    /**
+     * @param   g   any graph with vertices and adjacent_vertices
+     * @returns     one more than the largest vertex descriptor of g; removed
+     *              vertices leave holes, so this can exceed num_vertices(g)
+     */
+    template <typename G>
+    std::size_t vertex_bound (const G& g) {
+        std::size_t bound = 0;
+        std::pair<typename G::vertex_iterator, typename G::vertex_iterator> v = vertices(g);
+        for(; v.first != v.second; ++v.first)
+            bound = *v.first + 1;
+        return bound;
+    }
+
+    /**
+     * @param   g   any graph with vertices and adjacent_vertices
+     * @returns     the out-adjacency of g, in adjacent_vertices order, with an
+     *              empty row for every hole left by a removed vertex
+     */
+    template <typename G>
+    csr out_csr (const G& g) {
+        csr c;
+        c.offsets.reserve(vertex_bound(g) + 1);
+        c.targets.reserve(num_edges(g));
+        c.offsets.push_back(0);
+        std::pair<typename G::vertex_iterator, typename G::vertex_iterator> v = vertices(g);
+        for(; v.first != v.second; ++v.first) {
+            c.offsets.resize(*v.first + 1, c.targets.size());
+            std::pair<typename G::adjacency_iterator, typename G::adjacency_iterator> p = adjacent_vertices(*v.first, g);
+            for(; p.first != p.second; ++p.first)
+                c.targets.push_back(*p.first);
+            c.offsets.push_back(c.targets.size());
+        }
+        return c;
+    }
+
+    /**
+     * @param   c   an adjacency
+     * @returns     the adjacency with every edge reversed, sources in ascending order
+     */
+    inline csr transpose (const csr& c) {
+        csr t;
+        t.offsets.assign(c.size() + 2, 0);
+        for(std::size_t i = 0; i < c.targets.size(); ++i)
+            ++t.offsets[c.targets[i] + 2];
+        for(std::size_t v = 2; v < t.offsets.size(); ++v)
+            t.offsets[v] += t.offsets[v - 1];
+        t.targets.resize(c.targets.size());
+        for(std::size_t u = 0; u < c.size(); ++u) {
+            for(std::size_t i = c.offsets[u]; i < c.offsets[u + 1]; ++i)
+                t.targets[t.offsets[c.targets[i] + 1]++] = u;
+        }
+        t.offsets.pop_back();
+        return t;
+    }
+
+    /**
+     * @param   g   any graph with vertices and adjacent_vertices
+     * @returns     the in-degree of every vertex of g, indexed by descriptor
+     */
+    template <typename G>
+    std::vector<std::size_t> in_degrees (const G& g) {
+        std::vector<std::size_t> in(vertex_bound(g), 0);
+        std::pair<typename G::vertex_iterator, typename G::vertex_iterator> v = vertices(g);
+        for(; v.first != v.second; ++v.first) {
+            std::pair<typename G::adjacency_iterator, typename G::adjacency_iterator> p = adjacent_vertices(*v.first, g);
+            for(; p.first != p.second; ++p.first)
+                ++in[*p.first];
+        }
+        return in;
+    }
+
+    // ------------
+    // vertex_order
+    // ------------
+
+    /**
+     * @param   out         the out-adjacency of a graph, as out_csr returns it
+     * @param   live        live[v] is false for the holes left by removed vertices
+     * @param   strategy    the order to compute
+     * @returns             the live vertices in their new order, so the vertex at
+     *                      position i becomes vertex i
+     */
+    inline std::vector<std::size_t> vertex_order (const csr& out, const std::vector<char>& live, reorder_strategy strategy) {
+        const std::size_t n = out.size();
+        const csr         in = transpose(out);
+        std::vector<std::size_t> degree(n);
+        for(std::size_t v = 0; v < n; ++v)
+            degree[v] = out.degree(v) + in.degree(v);
+
+        std::vector<std::size_t> order;
+        order.reserve(n);
+        if(strategy == degree_descending) {
+            for(std::size_t v = 0; v < n; ++v) {
+                if(live[v])
+                    order.push_back(v);
+            }
+            std::stable_sort(order.begin(), order.end(), [&] (std::size_t u, std::size_t v) {
+                return degree[u] > degree[v];});
+            return order;
+        }
+
+        // both remaining orders search the graph as if it were undirected
+        std::vector<std::size_t> starts;
+        starts.reserve(n);
+        for(std::size_t v = 0; v < n; ++v) {
+            if(live[v])
+                starts.push_back(v);
+        }
+        if(strategy == reverse_cuthill_mckee)
+            std::stable_sort(starts.begin(), starts.end(), [&] (std::size_t u, std::size_t v) {
+                return degree[u] < degree[v];});
+        std::vector<char> seen(n, 0);
+        for(std::size_t i = 0; i < starts.size(); ++i) {
+            if(seen[starts[i]])
+                continue;
+            seen[starts[i]] = 1;
+            order.push_back(starts[i]);
+            for(std::size_t head = order.size() - 1; head < order.size(); ++head) {
+                const std::size_t u    = order[head];
+                const std::size_t tail = order.size();
+                for(std::size_t k = out.offsets[u]; k < out.offsets[u + 1]; ++k) {
+                    if(!seen[out.targets[k]]) {
+                        seen[out.targets[k]] = 1;
+                        order.push_back(out.targets[k]);
+                    }
+                }
+                for(std::size_t k = in.offsets[u]; k < in.offsets[u + 1]; ++k) {
+                    if(!seen[in.targets[k]]) {
+                        seen[in.targets[k]] = 1;
+                        order.push_back(in.targets[k]);
+                    }
+                }
+                if(strategy == reverse_cuthill_mckee)
+                    std::stable_sort(order.begin() + tail, order.end(), [&] (std::size_t a, std::size_t b) {
+                        return degree[a] < degree[b];});
+            }
+        }
+        if(strategy == reverse_cuthill_mckee)
+            std::reverse(order.begin(), order.end());
+        return order;
+    }
+
+    // ------------
+    // weighted_csr
+    // ------------
+
+    /**
+     * A csr whose entries also carry the weight of their edge.
+     */
+    template <typename W>
+    struct weighted_csr {
+        std::vector<std::size_t> offsets;
+        std::vector<std::size_t> targets;
+        std::vector<W>           weights;
+
+        /**
+         * @returns the number of vertices
+         */
+        std::size_t size () const {
+            return offsets.size() - 1;
+        }
+    };
+
+    /**
+     * @param   g       any graph with vertices, edges, source and target
+     * @param   weight  the weight of every edge of g, indexed by edge descriptor
+     * @returns         the weighted out-adjacency of g, each row in edges order
+     */
+    template <typename G, typename WeightMap>
+    weighted_csr<typename WeightMap::value_type> out_weighted_csr (const G& g, const WeightMap& weight) {
+        weighted_csr<typename WeightMap::value_type> c;
+        c.offsets.assign(vertex_bound(g) + 2, 0);
+        std::pair<typename G::edge_iterator, typename G::edge_iterator> p = edges(g);
+        for(; p.first != p.second; ++p.first)
+            ++c.offsets[source(*p.first, g) + 2];
+        for(std::size_t v = 2; v < c.offsets.size(); ++v)
+            c.offsets[v] += c.offsets[v - 1];
+        c.targets.resize(c.offsets.back());
+        c.weights.resize(c.offsets.back());
+        for(p = edges(g); p.first != p.second; ++p.first) {
+            const std::size_t i = c.offsets[source(*p.first, g) + 1]++;
+            c.targets[i] = target(*p.first, g);
+            c.weights[i] = weight[*p.first];
+        }
+        c.offsets.pop_back();
+        return c;
+    }
+
+    // ----------
+    // atomic_min
+    // ----------
+
+    /**
+     * lowers a to value unless it already holds something no larger
+     * @returns true if a was lowered
+     */
+    template <typename T>
+    bool atomic_min (std::atomic<T>& a, T value) {
+        T current = a.load(std::memory_order_relaxed);
+        while(value < current) {
+            if(a.compare_exchange_weak(current, value, std::memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+
+    // ----------
+    // atomic_max
+    // ----------
+
+    /**
+     * raises a to value unless it already holds something no smaller
+     * @returns true if a was raised
+     */
+    template <typename T>
+    bool atomic_max (std::atomic<T>& a, T value) {
+        T current = a.load(std::memory_order_relaxed);
+        while(current < value) {
+            if(a.compare_exchange_weak(current, value, std::memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+
+    // ----------
+    // union_find
+    // ----------
+
+    /**
+     * Lock-free disjoint sets over [0, n) (Anderson and Woll). Roots are linked
+     * toward the smaller index with a compare-and-swap, so there are never cycles,
+     * and find halves paths as it goes; unite and find may run on many threads.
+     */
+    class union_find {
+        private:
+            std::vector< std::atomic<std::size_t> > _parent;
+
+            union_find (const union_find&);
+            union_find& operator = (const union_find&);
+
+        public:
+            explicit union_find (std::size_t n) :
+                _parent(n) {
+                for(std::size_t v = 0; v < n; ++v)
+                    _parent[v].store(v, std::memory_order_relaxed);
+            }
+
+            /**
+             * @returns the root of x's set
+             */
+            std::size_t find (std::size_t x) {
+                for(;;) {
+                    std::size_t p = _parent[x].load(std::memory_order_relaxed);
+                    if(p == x)
+                        return x;
+                    const std::size_t gp = _parent[p].load(std::memory_order_relaxed);
+                    if(gp != p)
+                        _parent[x].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+                    x = gp;
+                }
+            }
+
+            /**
+             * merges the sets of x and y
+             */
+            void unite (std::size_t x, std::size_t y) {
+                for(;;) {
+                    x = find(x);
+                    y = find(y);
+                    if(x == y)
+                        return;
+                    if(x < y)
+                        std::swap(x, y);
+                    std::size_t expected = x;
+                    if(_parent[x].compare_exchange_strong(expected, y, std::memory_order_relaxed))
+                        return;
+                }
+            }
+    };
+
+    // -----
+    // reach
+    // -----
+
+    /**
+     * Sets flag in mark for every vertex reachable from root along c through
+     * vertices of root's part, root included. Each level is split across threads.
+     */
+    inline void reach (const csr& c, std::size_t root, const std::vector<std::size_t>& part,
+                       std::vector< std::atomic<unsigned char> >& mark, unsigned char flag) {
+        const std::size_t p = part[root];
+        mark[root].fetch_or(flag, std::memory_order_relaxed);
+        std::vector<std::size_t> frontier(1, root);
+        std::mutex               lock;
+        while(!frontier.empty()) {
+            std::vector<std::size_t> next;
+            parallel_for(frontier.size(), [&] (std::size_t b, std::size_t e) {
+                std::vector<std::size_t> found;
+                for(std::size_t i = b; i < e; ++i) {
+                    const std::size_t u = frontier[i];
+                    for(std::size_t k = c.offsets[u]; k < c.offsets[u + 1]; ++k) {
+                        const std::size_t v = c.targets[k];
+                        if(part[v] == p && !(mark[v].load(std::memory_order_relaxed) & flag) &&
+                           !(mark[v].fetch_or(flag, std::memory_order_relaxed) & flag))
+                            found.push_back(v);
+                    }
+                }
+                std::lock_guard<std::mutex> guard(lock);
+                next.insert(next.end(), found.begin(), found.end());}, 256);
+            frontier.swap(next);
+        }
+    }
+
+    // ------------
+    // dense_labels
+    // ------------
+
+    /**
+     * Renumbers the labels of component 0, 1, 2, ... in order of their first
+     * vertex, leaving entries of none alone.
+     * @returns the number of distinct labels
+     */
+    inline std::size_t dense_labels (std::vector<std::size_t>& component, std::size_t none) {
+        std::vector<std::size_t> renamed(component.size(), none);
+        std::size_t count = 0;
+        for(std::size_t v = 0; v < component.size(); ++v) {
+            if(component[v] == none)
+                continue;
+            std::size_t& r = renamed[component[v]];
+            if(r == none)
+                r = count++;
+            component[v] = r;
+        }
+        return count;
+    }
+
+    // ---------
+    // dary_heap
+    // ---------
+
+    /**
+     * An indexed min-heap of the vertices [0, n) keyed by an external array,
+     * with decrease-key. Four children per node keeps a sift-down within one or
+     * two cache lines and halves the depth of a binary heap.
+     */
+    template <typename K>
+    class dary_heap {
+        private:
+            static const std::size_t arity = 4;
+            static const std::size_t npos  = static_cast<std::size_t>(-1);
+
+            const std::vector<K>&    _keys;
+            std::vector<std::size_t> _heap;
+            std::vector<std::size_t> _pos;
+
+            void place (std::size_t i, std::size_t v) {
+                _heap[i] = v;
+                _pos[v]  = i;
+            }
+
+            void sift_up (std::size_t i) {
+                const std::size_t v = _heap[i];
+                while(i != 0 && _keys[v] < _keys[_heap[(i - 1) / arity]]) {
+                    place(i, _heap[(i - 1) / arity]);
+                    i = (i - 1) / arity;
+                }
+                place(i, v);
+            }
+
+            void sift_down (std::size_t i) {
+                const std::size_t v = _heap[i];
+                for(;;) {
+                    const std::size_t first = arity * i + 1;
+                    if(first >= _heap.size())
+                        break;
+                    const std::size_t last = std::min(first + arity, _heap.size());
+                    std::size_t best = first;
+                    for(std::size_t c = first + 1; c < last; ++c) {
+                        if(_keys[_heap[c]] < _keys[_heap[best]])
+                            best = c;
+                    }
+                    if(!(_keys[_heap[best]] < _keys[v]))
+                        break;
+                    place(i, _heap[best]);
+                    i = best;
+                }
+                place(i, v);
+            }
+
+        public:
+            /**
+             * @param keys  the key of every vertex; must outlive the heap
+             */
+            explicit dary_heap (const std::vector<K>& keys) :
+                _keys(keys),
+                _pos(keys.size(), std::size_t(npos))
+            {}
+
+            bool empty () const {
+                return _heap.empty();
+            }
+
+            /**
+             * inserts v, or restores the heap after keys[v] was lowered
+             */
+            void push_or_decrease (std::size_t v) {
+                if(_pos[v] == npos) {
+                    _heap.push_back(v);
+                    _pos[v] = _heap.size() - 1;
+                }
+                sift_up(_pos[v]);
+            }
+
+            /**
+             * removes and returns the vertex with the smallest key
+             */
+            std::size_t pop () {
+                const std::size_t top = _heap[0];
+                _pos[top] = npos;
+                const std::size_t last = _heap.back();
+                _heap.pop_back();
+                if(!_heap.empty()) {
+                    place(0, last);
+                    sift_down(0);
+                }
+                return top;
+            }
+    };
+
+    // ---------
+    // intersect
+    // ---------
+
+    /**
+     * @param a     a sorted range without duplicates
+     * @param na    its length
+     * @param b     another sorted range without duplicates
+     * @param nb    its length
+     * @returns     the number of values in both ranges
+     */
+    template <typename T>
+    std::size_t intersect_scalar (const T *a, std::size_t na, const T *b, std::size_t nb) {
+        std::size_t count = 0;
+        std::size_t i     = 0;
+        std::size_t j     = 0;
+        while(i < na && j < nb) {
+            const T x = a[i];
+            const T y = b[j];
+            count += x == y;
+            i     += x <= y;
+            j     += y <= x;
+        }
+        return count;
+    }
+
+    /**
+     * intersect_scalar for a range much shorter than the other: binary searches
+     * the long range for each value of the short one
+     */
+    template <typename T>
+    std::size_t intersect_galloping (const T *a, std::size_t na, const T *b, std::size_t nb) {
+        if(na > nb)
+            return intersect_galloping(b, nb, a, na);
+        std::size_t count = 0;
+        const T    *first = b;
+        for(std::size_t i = 0; i < na; ++i) {
+            first = std::lower_bound(first, b + nb, a[i]);
+            if(first == b + nb)
+                break;
+            count += *first == a[i];
+        }
+        return count;
+    }
+
+#ifdef GRAPH_X86_KERNELS
+    /**
+     * intersect_scalar four values at a time: each block of a is compared with
+     * all four rotations of the current block of b, then whichever block has the
+     * smaller maximum moves on (Schlegel, Willhalm and Lehner)
+     */
+    __attribute__((target("sse2")))
+    inline std::size_t intersect_sse (const std::uint32_t *a, std::size_t na, const std::uint32_t *b, std::size_t nb) {
+        std::size_t count = 0;
+        std::size_t i     = 0;
+        std::size_t j     = 0;
+        while(i + 4 <= na && j + 4 <= nb) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+            __m128i m = _mm_cmpeq_epi32(x, y);
+            m = _mm_or_si128(m, _mm_cmpeq_epi32(x, _mm_shuffle_epi32(y, _MM_SHUFFLE(0, 3, 2, 1))));
+            m = _mm_or_si128(m, _mm_cmpeq_epi32(x, _mm_shuffle_epi32(y, _MM_SHUFFLE(1, 0, 3, 2))));
+            m = _mm_or_si128(m, _mm_cmpeq_epi32(x, _mm_shuffle_epi32(y, _MM_SHUFFLE(2, 1, 0, 3))));
+            count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(m)));
+            const std::uint32_t ax = a[i + 3];
+            const std::uint32_t by = b[j + 3];
+            i += 4 * (ax <= by);
+            j += 4 * (by <= ax);
+        }
+        return count + intersect_scalar(a + i, na - i, b + j, nb - j);
+    }
+
+    /**
+     * intersect_sse eight values at a time
+     */
+    __attribute__((target("avx2")))
+    inline std::size_t intersect_avx2 (const std::uint32_t *a, std::size_t na, const std::uint32_t *b, std::size_t nb) {
+        const __m256i rotate = _mm256_set_epi32(0, 7, 6, 5, 4, 3, 2, 1);
+        std::size_t count = 0;
+        std::size_t i     = 0;
+        std::size_t j     = 0;
+        while(i + 8 <= na && j + 8 <= nb) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            __m256i       y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + j));
+            __m256i       m = _mm256_cmpeq_epi32(x, y);
+            for(int k = 1; k < 8; ++k) {
+                y = _mm256_permutevar8x32_epi32(y, rotate);
+                m = _mm256_or_si256(m, _mm256_cmpeq_epi32(x, y));
+            }
+            count += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(m)));
+            const std::uint32_t ax = a[i + 7];
+            const std::uint32_t by = b[j + 7];
+            i += 8 * (ax <= by);
+            j += 8 * (by <= ax);
+        }
+        return count + intersect_sse(a + i, na - i, b + j, nb - j);
+    }
+#endif
+
+    typedef std::size_t (*intersect_kernel) (const std::uint32_t*, std::size_t, const std::uint32_t*, std::size_t);
+
+    /**
+     * @returns the widest intersection kernel this processor runs
+     */
+    inline intersect_kernel select_intersect () {
+#ifdef GRAPH_X86_KERNELS
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2"))
+            return intersect_avx2;
+        if(__builtin_cpu_supports("sse2"))
+            return intersect_sse;
+#endif
+        return intersect_scalar<std::uint32_t>;
+    }
+
+    /**
+     * intersect_scalar through the kernel select_intersect picks on first use,
+     * or intersect_galloping when one range is over 32 times the other
+     */
+    inline std::size_t intersect (const std::uint32_t *a, std::size_t na, const std::uint32_t *b, std::size_t nb) {
+        static const intersect_kernel kernel = select_intersect();
+        if(na > 32 * nb || nb > 32 * na)
+            return intersect_galloping(a, na, b, nb);
+        return kernel(a, na, b, nb);
+    }
+
+    /**
+     * intersect for values too wide for the SIMD kernels
+     */
+    template <typename T>
+    std::size_t intersect (const T *a, std::size_t na, const T *b, std::size_t nb) {
+        if(na > 32 * nb || nb > 32 * na)
+            return intersect_galloping(a, na, b, nb);
+        return intersect_scalar(a, na, b, nb);
+    }
+
+    // --------------
+    // sorted_targets
+    // --------------
+
+    /**
+     * @param   vd  a vertex of g
+     * @param   g   any graph with adjacent_vertices
+     * @param   t   set to the distinct targets of vd's out-edges in ascending
+     *              order; rows that are already sorted are only copied
+     * @returns     false, leaving t incomplete, if a target does not fit in T
+     */
+    template <typename T, typename G>
+    bool sorted_targets (typename G::vertex_descriptor vd, const G& g, std::vector<T>& t) {
+        t.clear();
+        std::pair<typename G::adjacency_iterator, typename G::adjacency_iterator> p = adjacent_vertices(vd, g);
+        for(; p.first != p.second; ++p.first) {
+            if(*p.first > std::numeric_limits<T>::max())
+                return false;
+            t.push_back(T(*p.first));
+        }
+        if(!std::is_sorted(t.begin(), t.end())) {
+            std::sort(t.begin(), t.end());
+            t.erase(std::unique(t.begin(), t.end()), t.end());
+        }
+        return true;
+    }
+
+    // ---------------
+    // count_triangles
+    // ---------------
+
+    /**
+     * the body of triangle_count, with rows of T, which must hold every vertex
+     * of out; only std::uint32_t rows use the SIMD kernels
+     */
+    template <typename T>
+    std::size_t count_triangles (const csr& out) {
+        const csr         in = transpose(out);
+        const std::size_t n  = out.size();
+        assert(n == 0 || n - 1 <= std::numeric_limits<T>::max());
+
+        // the sorted, distinct undirected neighbours of every vertex
+        std::vector<std::size_t> offsets(n + 1, 0);
+        for(std::size_t v = 0; v < n; ++v)
+            offsets[v + 1] = offsets[v] + out.degree(v) + in.degree(v);
+        std::vector<T>           both(offsets[n]);
+        std::vector<std::size_t> degree(n);
+        parallel_for(n, [&] (std::size_t b, std::size_t e) {
+            for(std::size_t v = b; v < e; ++v) {
+                T *row = both.data() + offsets[v];
+                T *end = std::copy(out.targets.begin() + out.offsets[v], out.targets.begin() + out.offsets[v + 1], row);
+                end = std::copy(in.targets.begin() + in.offsets[v], in.targets.begin() + in.offsets[v + 1], end);
+                std::sort(row, end);
+                end = std::unique(row, end);
+                end = std::remove(row, end, T(v));
+                degree[v] = end - row;
+            }}, 1024);
+
+        // keep the neighbours ranked above each vertex
+        auto above = [&] (std::size_t u, std::size_t v) {
+            return degree[u] < degree[v] || (degree[u] == degree[v] && u < v);};
+        std::vector<std::size_t> forward(n + 1, 0);
+        for(std::size_t u = 0; u < n; ++u) {
+            std::size_t k = 0;
+            for(std::size_t i = offsets[u]; i < offsets[u] + degree[u]; ++i) {
+                if(above(u, both[i]))
+                    both[offsets[u] + k++] = both[i];
+            }
+            forward[u + 1] = forward[u] + k;
+        }
+        std::vector<T> rows(forward[n]);
+        for(std::size_t u = 0; u < n; ++u)
+            std::copy(both.begin() + offsets[u], both.begin() + offsets[u] + (forward[u + 1] - forward[u]), rows.begin() + forward[u]);
+        std::vector<T>().swap(both);
+
+        std::atomic<std::size_t> triangles(0);
+        parallel_for(n, [&] (std::size_t b, std::size_t e) {
+            std::size_t local = 0;
+            for(std::size_t u = b; u < e; ++u) {
+                const T          *row = rows.data() + forward[u];
+                const std::size_t nu  = forward[u + 1] - forward[u];
+                for(std::size_t i = 0; i < nu; ++i) {
+                    const std::size_t v = row[i];
+                    local += intersect(row, nu, rows.data() + forward[v], forward[v + 1] - forward[v]);
+                }
+            }
+            triangles.fetch_add(local, std::memory_order_relaxed);}, 1024);
+        return triangles.load();
+    }
+}
+
+// -----------
+// graph_stats
+// -----------
+
+/**
+ * Define GRAPH_STATS before including Graph.h to make every basic_graph count
+ * its edge lookups, probes and reallocations; stats(g) returns the counts.
+ * Without it the counters are not even members, and the hooks are empty
+ * inline functions.
+ */
+struct graph_stats {
+    /**
+     * the counters, each a probe count following its call count
+     */
+    enum counter {
+        add_edge_calls,     //add_edge calls and add_edges pairs
+        add_edge_probes,    //adjacency entries or hub indices they examined
+        edge_calls,         //edge and remove_edge(u, v) calls
+        edge_probes,        //adjacency entries or hub indices they examined
+        reallocations,      //appends that outgrew a vector's capacity
+        bytes_copied,       //bytes those reallocations moved
+        counters,
+        uncounted = counters
+    };
+
+    std::atomic<std::uint64_t> count[counters];
+
+    graph_stats () {
+        reset();
+    }
+
+    graph_stats (const graph_stats& that) {
+        *this = that;
+    }
+
+    graph_stats& operator = (const graph_stats& that) {
+        for(int c = 0; c < counters; ++c)
+            count[c].store(that[counter(c)], std::memory_order_relaxed);
+        return *this;
+    }
+
+    /**
+     * @param c     a counter
+     * @returns     its value
+     */
+    std::uint64_t operator [] (counter c) const {
+        return count[c].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * adds n to counter c; safe from several threads, as add_edges needs
+     */
+    void add (counter c, std::uint64_t n) {
+        count[c].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    /**
+     * sets every counter to 0
+     */
+    void reset () {
+        for(int c = 0; c < counters; ++c)
+            count[c].store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @param calls add_edge_calls or edge_calls
+     * @returns     the mean probes per call, 0 before the first call
+     */
+    double probes_per_call (counter calls) const {
+        return (*this)[calls] == 0 ? 0 : double((*this)[counter(calls + 1)]) / (*this)[calls];
+    }
+};
+
+// ------------
+// graph_memory
+// ------------
+
+/**
+ * The bytes held by each internal structure of a basic_graph, as memory_usage
+ * reports them: vector headers and capacity, and for hash tables their buckets
+ * and nodes, without allocator overhead.
+ */
+struct graph_memory {
+    std::size_t adjacency;  //out-edge rows
+    std::size_t in_edges;   //in-edge rows of a bidirectional graph
+    std::size_t edge_list;  //global (source, target) list
+    std::size_t hub_index;  //target indices of high degree vertices
+    std::size_t removed;    //removed-vertex bitmap
+
+    /**
+     * @returns the sum of the parts
+     */
+    std::size_t total () const {
+        return adjacency + in_edges + edge_list + hub_index + removed;
+    }
+};
+
+// ----------------
+// degree_histogram
+// ----------------
+
+/**
+ * @param   g   any graph with vertices and adjacent_vertices
+ * @returns     h with h[0] the number of vertices of out-degree 0 and h[k] the
+ *              number of out-degree in [2^(k-1), 2^k)
+ */
+template <typename G>
+std::vector<std::size_t> degree_histogram (const G& g) {
+    std::vector<std::size_t> h(1, 0);
+    std::pair<typename G::vertex_iterator, typename G::vertex_iterator> v = vertices(g);
+    for(; v.first != v.second; ++v.first) {
+        std::size_t d = 0;
+        std::pair<typename G::adjacency_iterator, typename G::adjacency_iterator> p = adjacent_vertices(*v.first, g);
+        for(; p.first != p.second; ++p.first)
+            ++d;
+        std::size_t k = 0;
+        for(; d != 0; d >>= 1)
+            ++k;
+        if(k >= h.size())
+            h.resize(k + 1, 0);
+        ++h[k];
+    }
+    return h;
+}
+
+// ----------
+// reordering
+// ----------
+
+/**
+ * What reorder returns: the relabeled graph and, indexed by old descriptor, the
+ * new descriptor of every vertex and edge number of every edge. Removed vertices
+ * and edges map to std::numeric_limits<Descriptor>::max(). A property array p of
+ * the old graph moves to the new one in a single pass: q[edge_map[e]] = p[e].
+ */
+template <typename G, typename Descriptor>
+struct reordering {
+    G                       graph;
+    std::vector<Descriptor> vertex_map;
+    std::vector<Descriptor> edge_map;
+};
+
+// -----------
+// basic_graph
+// -----------
+
+/**
+ * A simple graph implementation based on boost's adjacency_list.
+ * Descriptor is the unsigned integer type of vertex descriptors and edge numbers;
+ * std::uint32_t halves the adjacency lists of graphs with fewer than 2^32 - 1
+ * vertices and edges. With EdgeList, a global (source, target) list makes an edge
+ * descriptor a plain edge number and source/target O(1) lookups; without it, each
+ * edge is stored only in its source's adjacency list and edge descriptors are
+ * edge structs that carry their own endpoints.
+ */
+template <typename Descriptor, bool EdgeList>
+class basic_graph {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef Descriptor      vertex_descriptor;
+
+        /**
+         * an edge descriptor of a graph without an edge list
+         */
+        struct edge {
+            Descriptor          edge_no;
+            vertex_descriptor   source;
+            vertex_descriptor   target;
+
+            friend bool operator == (const edge& lhs, const edge& rhs) {
+                return lhs.edge_no == rhs.edge_no;
+            }
+
+            friend bool operator != (const edge& lhs, const edge& rhs) {
+                return !(lhs == rhs);
+            }
+        };
+
+        typedef typename std::conditional<EdgeList, Descriptor, edge>::type edge_descriptor;
+
+        class vert_iter;
+        class edge_iter;
+        class adj_iter;
+        class in_edge_iter;
+        class inv_adj_iter;
+
+        typedef vert_iter       vertex_iterator;
+        typedef edge_iter       edge_iterator;
+        typedef adj_iter        adjacency_iterator;
+        typedef in_edge_iter    in_edge_iterator;
+        typedef inv_adj_iter    inv_adjacency_iterator;
+
+        typedef std::size_t     vertices_size_type;
+        typedef std::size_t     edges_size_type;
+        typedef std::size_t     degree_size_type;
+
+        /**
+         * directed graphs store out-edges only; bidirectional graphs also keep
+         * an in-edge list per vertex for in_edges, in_degree and inv_adjacent_vertices
+         */
+        enum direction {directed, bidirectional};
+
+    /**
+     * vertex iterator
+     * will iterate over every vertex in the graph
+     */
+    class vert_iter {
+      private:
+        std::size_t index;
+        const basic_graph *owner;
+
+        /**
+         * moves past removed vertices
+         */
+        void skip () {
+            if(owner->_dead_vertices == 0)
+                return;
+            while(index < owner->vertex_label && owner->_removed[index])
+                ++index;
+        }
+
+      public:
+        /**
+         * checks to see if the lhs == rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  true if the lhs and rhs point to the same value
+         */
+        friend bool operator == (const vert_iter& lhs, const vert_iter& rhs) {
+            return (lhs.owner == rhs.owner) && (lhs.index == rhs.index);;
+        }
+
+        /**
+         * checks to see if the lhs != rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  false if the lhs and rhs point to the same value
+         */
+        friend bool operator != (const vert_iter& lhs, const vert_iter& rhs) {
+            return !(lhs == rhs);
+        }
+
+        /**
+         * creates a new vertex iterator
+         * @param   *owner the graph from which this iterator represents
+         * @param   ed the index of this iterator
+         */
+        vert_iter(const basic_graph *owner_, std::size_t ed) :
+            index(ed),
+            owner(owner_)
+        {
+            assert(ed >= 0);
+            skip();
+        }
+
+        /**
+         * dereference this iterator
+         * @returns the value at which this iterator is pointing
+         */
+        vertex_descriptor operator * () const {
+            return index;
+        }
+
+        /**
+         * (pre)increment this iterator
+         * @returns this with its new value
+         */
+        vert_iter& operator ++ () {
+            ++index;
+            skip();
+            return *this;
+        }
+    };
+
+    /**
+     * edge iterator
+     * will iterate over every edge in the graph: in edge_list order with an edge
+     * list, otherwise row by row through the adjacency lists
+     */
+    class edge_iter {
+      private:
+        std::size_t vertex;
+        std::size_t index;
+        const basic_graph *owner;
+
+        /**
+         * moves past removed edges and, without an edge list, past the end of each row
+         */
+        void skip () {
+            if(EdgeList) {
+                if(owner->_dead_edges == 0)
+                    return;
+                while(index < owner->edge_label && owner->edge_list[index].target == tombstone)
+                    ++index;
+                return;
+            }
+            while(vertex < owner->vertex_label) {
+                const std::vector<out_edge>& row = owner->_g[vertex];
+                while(index < row.size() && row[index].target == tombstone)
+                    ++index;
+                if(index < row.size())
+                    return;
+                ++vertex;
+                index = 0;
+            }
+        }
+
+      public:
+        /**
+         * checks to see if the lhs == rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  true if the lhs and rhs point to the same value
+         */
+        friend bool operator == (const edge_iter& lhs, const edge_iter& rhs) {
+            return (lhs.owner == rhs.owner) && (lhs.index == rhs.index) && (lhs.vertex == rhs.vertex);
+        }
+
+        /**
+         * checks to see if the lhs != rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  false if the lhs and rhs point to the same value
+         */
+        friend bool operator != (const edge_iter& lhs, const edge_iter& rhs) {
+            return !(lhs == rhs);
+        }
+
+        /**
+         * creates a new edge iterator
+         * @param   *owner the graph from which this iterator represents
+         * @param   vert the row of this iterator, always 0 with an edge list
+         * @param   ed the index of this iterator
+         */
+        edge_iter(const basic_graph *owner_, std::size_t vert, std::size_t ed) :
+            vertex(vert),
+            index(ed),
+            owner(owner_)
+        {
+            assert(ed >= 0);
+            skip();
+        }
+
+        /**
+         * dereference this iterator
+         * @returns the value at which this iterator is pointing
+         */
+        edge_descriptor operator * () const {
+            if(EdgeList)
+                return describe(index, 0, 0);
+            const out_edge& e = owner->_g[vertex][index];
+            return describe(e.edge_no, vertex, e.target);
+        }
+
+        /**
+         * (pre)increment this iterator
+         * @returns this with its new value
+         */
+        edge_iter& operator ++ () {
+            ++index;
+            skip();
+            return *this;
+        }
+    };
+
+    /**
+     * adjacent vertece iterator
+     * will iterate over every vertex in the graph that has an edge from given vertex
+     */
+    class adj_iter {
+      private:
+        vertex_descriptor vertex;
+        std::size_t index;
+        const basic_graph *owner;
+
+        /**
+         * moves past removed edges
+         */
+        void skip () {
+            if(owner->_dead_edges == 0)
+                return;
+            const std::vector<out_edge>& row = owner->_g[vertex];
+            while(index < row.size() && row[index].target == tombstone)
+                ++index;
+        }
+
+      public:
+        /**
+         * checks to see if the lhs == rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  true if the lhs and rhs point to the same value
+         */
+        friend bool operator == (const adj_iter& lhs, const adj_iter& rhs) {
+            return (lhs.owner == rhs.owner) && (lhs.index == rhs.index) && (lhs.vertex == rhs.vertex);
+        }
+
+        /**
+         * checks to see if the lhs != rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  false if the lhs and rhs point to the same value
+         */
+        friend bool operator != (const adj_iter& lhs, const adj_iter& rhs) {
+            return !(lhs == rhs);
+        }
+
+        /**
+         * creates a new adjcent vertex iterator
+         * @param   *owner the graph from which this iterator represents
+         * @param   ed the index of this iterator
+         * @param   vert the vertex of which to look at
+         */
+        adj_iter(const basic_graph *owner_, std::size_t ed, vertex_descriptor vert) :
+            vertex(vert),
+            index(ed),
+            owner(owner_)
+        {
+            assert(ed >= 0);
+            skip();
+        }
+
+        /**
+         * dereference this iterator
+         * @returns the value at which this iterator is pointing
+         */
+        vertex_descriptor operator * () const {
+            return owner->_g[vertex][index].target;
+        }
+
+        /**
+         * (pre)increment this iterator
+         * @returns this with its new value
+         */
+        adj_iter& operator ++ () {
+            ++index;
+            skip();
+            return *this;
+        }
+    };
+
+    /**
+     * in-edge iterator
+     * will iterate over every edge in the graph that ends at a given vertex
+     */
+    class in_edge_iter {
+      private:
+        vertex_descriptor vertex;
+        std::size_t index;
+        const basic_graph *owner;
+
+        /**
+         * moves past removed edges
+         */
+        void skip () {
+            if(owner->_dead_edges == 0)
+                return;
+            const std::vector<in_edge>& row = owner->_in[vertex];
+            while(index < row.size() && row[index].source == tombstone)
+                ++index;
+        }
+
+      public:
+        /**
+         * checks to see if the lhs == rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  true if the lhs and rhs point to the same value
+         */
+        friend bool operator == (const in_edge_iter& lhs, const in_edge_iter& rhs) {
+            return (lhs.owner == rhs.owner) && (lhs.index == rhs.index) && (lhs.vertex == rhs.vertex);
+        }
+
+        /**
+         * checks to see if the lhs != rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  false if the lhs and rhs point to the same value
+         */
+        friend bool operator != (const in_edge_iter& lhs, const in_edge_iter& rhs) {
+            return !(lhs == rhs);
+        }
+
+        /**
+         * creates a new in-edge iterator
+         * @param   *owner the graph from which this iterator represents
+         * @param   ed the index of this iterator
+         * @param   vert the vertex of which to look at
+         */
+        in_edge_iter(const basic_graph *owner_, std::size_t ed, vertex_descriptor vert) :
+            vertex(vert),
+            index(ed),
+            owner(owner_)
+        {
+            skip();
+        }
+
+        /**
+         * dereference this iterator
+         * @returns the edge descriptor at which this iterator is pointing
+         */
+        edge_descriptor operator * () const {
+            const in_edge& e = owner->_in[vertex][index];
+            return describe(e.edge_no, e.source, vertex);
+        }
+
+        /**
+         * (pre)increment this iterator
+         * @returns this with its new value
+         */
+        in_edge_iter& operator ++ () {
+            ++index;
+            skip();
+            return *this;
+        }
+    };
+
+    /**
+     * inverse adjacent vertex iterator
+     * will iterate over every vertex in the graph that has an edge to a given vertex
+     */
+    class inv_adj_iter {
+      private:
+        vertex_descriptor vertex;
+        std::size_t index;
+        const basic_graph *owner;
+
+        /**
+         * moves past removed edges
+         */
+        void skip () {
+            if(owner->_dead_edges == 0)
+                return;
+            const std::vector<in_edge>& row = owner->_in[vertex];
+            while(index < row.size() && row[index].source == tombstone)
+                ++index;
+        }
+
+      public:
+        /**
+         * checks to see if the lhs == rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  true if the lhs and rhs point to the same value
+         */
+        friend bool operator == (const inv_adj_iter& lhs, const inv_adj_iter& rhs) {
+            return (lhs.owner == rhs.owner) && (lhs.index == rhs.index) && (lhs.vertex == rhs.vertex);
+        }
+
+        /**
+         * checks to see if the lhs != rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  false if the lhs and rhs point to the same value
+         */
+        friend bool operator != (const inv_adj_iter& lhs, const inv_adj_iter& rhs) {
+            return !(lhs == rhs);
+        }
+
+        /**
+         * creates a new inverse adjacent vertex iterator
+         * @param   *owner the graph from which this iterator represents
+         * @param   ed the index of this iterator
+         * @param   vert the vertex of which to look at
+         */
+        inv_adj_iter(const basic_graph *owner_, std::size_t ed, vertex_descriptor vert) :
+            vertex(vert),
+            index(ed),
+            owner(owner_)
+        {
+            skip();
+        }
+
+        /**
+         * dereference this iterator
+         * @returns the source vertex at which this iterator is pointing
+         */
+        vertex_descriptor operator * () const {
+            return owner->_in[vertex][index].source;
+        }
+
+        /**
+         * (pre)increment this iterator
+         * @returns this with its new value
+         */
+        inv_adj_iter& operator ++ () {
+            ++index;
+            skip();
+            return *this;
+        }
+    };
+    public:
+        // --------
+        // add_edge
+        // --------
+
+        /**
+         * Adds edge (vdS,vdT) to the graph and returns the edge descriptor for the new edge
+         * @param vdS   the vertex descriptor of the source
+         * @param vdT   the vertex descriptor of the target
+         * @param g     the graph to add the edge to
+         * @returns     a pair with the edge descriptor and a boolean indicating whether or
+         *              not an edge was added
+         */
+        friend std::pair<edge_descriptor, bool> add_edge (vertex_descriptor vdS, vertex_descriptor vdT, basic_graph& g) {
+            assert(vdS >= 0);
+            assert(vdT >= 0);
+            assert(!g.removed(vdS) && !g.removed(vdT));
+            
+            std::pair<edge_descriptor, bool> found = g.find_edge(vdS, vdT, graph_stats::add_edge_calls);
+            if(found.second)
+                return std::make_pair(found.first, false);
+            
+            return std::make_pair(g.append_edge(vdS, vdT), true);
+        }
+
+        // ---------
+        // add_edges
+        // ---------
+
+        /**
+         * Adds every (source, target) pair in [first, last) to the graph. The pairs are
+         * sorted and deduplicated in parallel and then appended in one pass, but the
+         * edges get the same descriptors, in the same order, as calling add_edge on
+         * each pair in turn would give them.
+         * @param first the beginning of a range of std::pair<vertex_descriptor, vertex_descriptor>
+         * @param last  the end of the range
+         * @param g     the graph to add the edges to
+         * @returns     the number of edges that were added
+         */
+        template <typename InputIterator>
+        friend edges_size_type add_edges (InputIterator first, InputIterator last, basic_graph& g) {
+            struct pending {
+                vertex_descriptor source;
+                vertex_descriptor target;
+                std::size_t       pos;
+            };
+            std::vector<pending> batch;
+            for(std::size_t pos = 0; first != last; ++first, ++pos) {
+                assert((*first).first < g.vertex_label && !g.removed((*first).first));
+                assert((*first).second < g.vertex_label && !g.removed((*first).second));
+                pending p = {(*first).first, (*first).second, pos};
+                batch.push_back(p);
+            }
+
+            graph_detail::parallel_sort(batch.begin(), batch.end(), [] (const pending& lhs, const pending& rhs) {
+                if(lhs.source != rhs.source)
+                    return lhs.source < rhs.source;
+                if(lhs.target != rhs.target)
+                    return lhs.target < rhs.target;
+                return lhs.pos < rhs.pos;
+            });
+
+            // keep the first occurrence of each pair that is not already an edge
+            std::vector<char> keep(batch.size());
+            graph_detail::parallel_for(batch.size(), [&] (std::size_t b, std::size_t e) {
+                for(std::size_t i = b; i < e; ++i)
+                    keep[i] = (i == 0 || batch[i - 1].source != batch[i].source || batch[i - 1].target != batch[i].target) &&
+                              !g.find_edge(batch[i].source, batch[i].target, graph_stats::add_edge_calls).second;
+            });
+            std::size_t n = 0;
+            for(std::size_t i = 0; i < batch.size(); ++i) {
+                if(keep[i])
+                    batch[n++] = batch[i];
+            }
+            batch.resize(n);
+
+            graph_detail::parallel_sort(batch.begin(), batch.end(), [] (const pending& lhs, const pending& rhs) {
+                return lhs.pos < rhs.pos;
+            });
+
+            std::vector<std::size_t> added(g.vertex_label, 0);
+            for(std::size_t i = 0; i < n; ++i)
+                ++added[batch[i].source];
+            for(std::size_t v = 0; v < g.vertex_label; ++v) {
+                if(added[v] != 0)
+                    g._g[v].reserve(g._g[v].size() + added[v]);
+            }
+            if(EdgeList)
+                g.edge_list.reserve(g.edge_list.size() + n);
+
+            for(std::size_t i = 0; i < n; ++i)
+                g.append_edge(batch[i].source, batch[i].target);
+            return n;
+        }
+
+        // ----------
+        // add_vertex
+        // ----------
+
+        /**
+         * Adds a vertex to the graph and returns the vertex descriptor for the new vertex.
+         * @param g         the graph to add a vertex to
+         * @returns         the vertex_descriptor of the added vertex
+         */
+        friend vertex_descriptor add_vertex (basic_graph& g) {
+            assert(g.vertex_label < vertex_descriptor(tombstone));
+            g.append(g._g, std::vector<out_edge>());
+            if(g._bidirectional)
+                g.append(g._in, std::vector<in_edge>());
+            if(!g._removed.empty())
+                g._removed.push_back(false);
+            return g.vertex_label++;
+        }
+
+        // ----------------
+        // reserve_vertices
+        // ----------------
+
+        /**
+         * Reserves room for n vertices so that add_vertex does not reallocate.
+         * @param n         the number of vertices to make room for
+         * @param g         the graph to reserve in
+         */
+        friend void reserve_vertices (vertices_size_type n, basic_graph& g) {
+            g._g.reserve(n);
+        }
+
+        // -------------
+        // reserve_edges
+        // -------------
+
+        /**
+         * Reserves room for n edges so that add_edge does not reallocate the edge list.
+         * Does nothing without an edge list.
+         * @param n         the number of edges to make room for
+         * @param g         the graph to reserve in
+         */
+        friend void reserve_edges (edges_size_type n, basic_graph& g) {
+            if(EdgeList)
+                g.edge_list.reserve(n);
+        }
+
+        // -----------------
+        // adjacent_vertices
+        // -----------------
+
+        /**
+         * Returns an iterator-range providing access to the vertices adjacent to vertex 
+         * u in graph g. For example, if u -> v is an edge in the graph, then v will be 
+         * in this iterator-range.
+         * @param   vd      the vertex to look at
+         * @param   g       the graph to look in
+         * @returns         a pair of iterators, begin and end
+         */
+        friend std::pair<adjacency_iterator, adjacency_iterator> adjacent_vertices (vertex_descriptor vd, const basic_graph& g) {
+            assert(vd >= 0);
+            return std::make_pair(adj_iter(&g, 0, vd), adj_iter(&g, g._g[vd].size(), vd));
+        }
+
+        // ---------
+        // in_degree
+        // ---------
+
+        /**
+         * Returns the number of edges that end at vertex vd. Requires a bidirectional graph.
+         * @param   vd      the vertex to look at
+         * @param   g       the graph to look in
+         * @returns         the in-degree of vd
+         */
+        friend degree_size_type in_degree (vertex_descriptor vd, const basic_graph& g) {
+            assert(g._bidirectional);
+            if(g._dead_edges == 0)
+                return g._in[vd].size();
+            degree_size_type d = 0;
+            for(typename std::vector<in_edge>::const_iterator it = g._in[vd].begin(); it != g._in[vd].end(); ++it)
+                d += (*it).source != tombstone;
+            return d;
+        }
+
+        // --------
+        // in_edges
+        // --------
+
+        /**
+         * Returns an iterator-range providing access to the edges that end at vertex vd,
+         * in the order they were added. Requires a bidirectional graph.
+         * @param   vd      the vertex to look at
+         * @param   g       the graph to look in
+         * @returns         a pair of iterators, begin and end
+         */
+        friend std::pair<in_edge_iterator, in_edge_iterator> in_edges (vertex_descriptor vd, const basic_graph& g) {
+            assert(g._bidirectional);
+            return std::make_pair(in_edge_iter(&g, 0, vd), in_edge_iter(&g, g._in[vd].size(), vd));
+        }
+
+        // ---------------------
+        // inv_adjacent_vertices
+        // ---------------------
+
+        /**
+         * Returns an iterator-range providing access to the vertices that have an edge to
+         * vertex vd. For example, if u -> v is an edge in the graph, then u will be in the
+         * iterator-range of v. Requires a bidirectional graph.
+         * @param   vd      the vertex to look at
+         * @param   g       the graph to look in
+         * @returns         a pair of iterators, begin and end
+         */
+        friend std::pair<inv_adjacency_iterator, inv_adjacency_iterator> inv_adjacent_vertices (vertex_descriptor vd, const basic_graph& g) {
+            assert(g._bidirectional);
+            return std::make_pair(inv_adj_iter(&g, 0, vd), inv_adj_iter(&g, g._in[vd].size(), vd));
+        }
+
+        // ----
+        // edge
+        // ----
+
+        /**
+         * If an edge from vertex u to vertex v exists, return a pair containing one such
+         * edge and true. If there are no edges between u and v, return a pair with an 
+         * arbitrary edge descriptor and false.
+         * @param   vdS     vertex descriptor of the source
+         * @param   vdT     vertex descriptor of the target
+         * @param   g       the graph to look in
+         * @returns         a pair including the edge descriptor of the found edge and a 
+         *                  boolean indicating whether or not an edge was found
+         */
+        friend std::pair<edge_descriptor, bool> edge (vertex_descriptor vdS, vertex_descriptor vdT, const basic_graph& g) {
+            assert(vdS >= 0);
+            assert(vdT >= 0);
+            return g.find_edge(vdS, vdT, graph_stats::edge_calls);
+        }
+
+        // -----
+        // edges
+        // -----
+
+        /**
+         * Returns an iterator-range providing access to the edge set of graph g.
+         * @param   g   the graph to look in
+         * @returns     a pair of iterators, begin and end encompassing all edges
+         */
+        friend std::pair<edge_iterator, edge_iterator> edges (const basic_graph& g) {
+            if(EdgeList)
+                return std::make_pair(edge_iter(&g, 0, 0), edge_iter(&g, 0, g.edge_label));
+            return std::make_pair(edge_iter(&g, 0, 0), edge_iter(&g, g.vertex_label, 0));
+        }
+
+        // ---------
+        // num_edges
+        // ---------
+
+        /**
+         * Returns the number of edges in the graph g.
+         * @param   g   the graph in question
+         * @returns     the number of edges in graph g
+         */
+        friend edges_size_type num_edges (const basic_graph& g) {
+            return g.edge_label - g._dead_edges;
+        }
+
+        // ------------
+        // num_vertices
+        // ------------
+
+        /**
+         * Returns the number of vertices in the graph g.
+         * @param   g   the graph in question
+         * @returns     the number of vertices in graph g
+         */
+        friend vertices_size_type num_vertices (const basic_graph& g) {
+            return g.vertex_label - g._dead_vertices;
+        }
+
+        // -----------
+        // remove_edge
+        // -----------
+
+        /**
+         * Removes edge (vdS,vdT) from the graph, if there is one. The edge is marked
+         * dead in place, so all other descriptors stay valid and iterators skip it;
+         * compact reclaims the space.
+         * @param vdS   the vertex descriptor of the source
+         * @param vdT   the vertex descriptor of the target
+         * @param g     the graph to remove the edge from
+         */
+        friend void remove_edge (vertex_descriptor vdS, vertex_descriptor vdT, basic_graph& g) {
+            const std::size_t slot = g.find_slot(vdS, vdT, graph_stats::edge_calls);
+            if(slot != g._g[vdS].size())
+                g.kill_edge(vdS, slot);
+        }
+
+        /**
+         * Removes edge ed from the graph. The edge is marked dead in place, so all
+         * other descriptors stay valid and iterators skip it; compact reclaims the space.
+         * @param ed    the edge descriptor of a live edge
+         * @param g     the graph to remove the edge from
+         */
+        friend void remove_edge (edge_descriptor ed, basic_graph& g) {
+            assert(g.live(ed));
+            g.kill_edge(g.source_of(ed), g.find_slot(g.source_of(ed), g.target_of(ed)));
+        }
+
+        // ------------
+        // clear_vertex
+        // ------------
+
+        /**
+         * Removes every edge into or out of vertex vd. Finding the in-edges costs
+         * O(in-degree) on a bidirectional graph and O(V + E) otherwise.
+         * @param vd    the vertex to clear
+         * @param g     the graph to look in
+         */
+        friend void clear_vertex (vertex_descriptor vd, basic_graph& g) {
+            assert(!g.removed(vd));
+            for(std::size_t i = 0; i < g._g[vd].size(); ++i) {
+                if(g._g[vd][i].target != tombstone)
+                    g.kill_edge(vd, i);
+            }
+            if(g._bidirectional) {
+                for(std::size_t i = 0; i < g._in[vd].size(); ++i) {
+                    if(g._in[vd][i].source != tombstone)
+                        g.kill_edge(g._in[vd][i].source, g.find_slot(g._in[vd][i].source, vd), i);
+                }
+            }
+            else {
+                for(vertex_descriptor u = 0; u < g.vertex_label; ++u) {
+                    for(std::size_t i = 0; i < g._g[u].size(); ++i) {
+                        if(g._g[u][i].target == vd)
+                            g.kill_edge(u, i);
+                    }
+                }
+            }
+        }
+
+        // -------------
+        // remove_vertex
+        // -------------
+
+        /**
+         * Removes vertex vd and every edge into or out of it. Unlike boost's vecS
+         * graphs, the other vertices keep their descriptors until compact.
+         * @param vd    the vertex to remove
+         * @param g     the graph to remove it from
+         */
+        friend void remove_vertex (vertex_descriptor vd, basic_graph& g) {
+            clear_vertex(vd, g);
+            if(g._removed.empty())
+                g._removed.resize(g.vertex_label, false);
+            g._removed[vd] = true;
+            ++g._dead_vertices;
+        }
+
+        // -------
+        // compact
+        // -------
+
+        /**
+         * Reclaims the space of removed vertices and edges in one linear pass.
+         * The surviving vertices and edges are renumbered densely in their existing
+         * order, which invalidates descriptors and iterators.
+         * @param g     the graph to compact
+         */
+        friend void compact (basic_graph& g) {
+            if(g._dead_edges == 0 && g._dead_vertices == 0)
+                return;
+
+            std::vector<vertex_descriptor> vmap(g.vertex_label, vertex_descriptor(tombstone));
+            vertex_descriptor nv = 0;
+            for(vertex_descriptor v = 0; v < g.vertex_label; ++v) {
+                if(!g.removed(v))
+                    vmap[v] = nv++;
+            }
+            std::vector<Descriptor> emap(g.edge_label, vertex_descriptor(tombstone));
+            for(vertex_descriptor v = 0; v < g.vertex_label; ++v) {
+                for(typename std::vector<out_edge>::const_iterator it = g._g[v].begin(); it != g._g[v].end(); ++it) {
+                    if((*it).target != tombstone)
+                        emap[(*it).edge_no] = 0;
+                }
+            }
+            Descriptor ne = 0;
+            for(std::size_t ed = 0; ed < g.edge_label; ++ed) {
+                if(emap[ed] == tombstone)
+                    continue;
+                if(EdgeList) {
+                    const endpoints& e = g.edge_list[ed];
+                    endpoints moved = {vmap[e.source], vmap[e.target]};
+                    g.edge_list[ne] = moved;
+                }
+                emap[ed] = ne++;
+            }
+            if(EdgeList)
+                g.edge_list.resize(ne);
+
+            g._hubs.clear();
+            for(vertex_descriptor v = 0; v < g.vertex_label; ++v) {
+                if(g.removed(v))
+                    continue;
+                std::vector<out_edge> row;
+                row.reserve(g._g[v].size());
+                for(typename std::vector<out_edge>::const_iterator it = g._g[v].begin(); it != g._g[v].end(); ++it) {
+                    if((*it).target != tombstone) {
+                        out_edge moved = {emap[(*it).edge_no], vmap[(*it).target]};
+                        row.push_back(moved);
+                    }
+                }
+                g._g[vmap[v]].swap(row);
+                if(g._g[vmap[v]].size() >= index_threshold)
+                    index_row(g._g[vmap[v]], g._hubs[vmap[v]]);
+                if(g._bidirectional) {
+                    std::vector<in_edge> in;
+                    for(typename std::vector<in_edge>::const_iterator it = g._in[v].begin(); it != g._in[v].end(); ++it) {
+                        if((*it).source != tombstone) {
+                            in_edge moved = {emap[(*it).edge_no], vmap[(*it).source]};
+                            in.push_back(moved);
+                        }
+                    }
+                    g._in[vmap[v]].swap(in);
+                }
+            }
+            g._g.resize(nv);
+            if(g._bidirectional)
+                g._in.resize(nv);
+
+            g.vertex_label   = nv;
+            g.edge_label     = ne;
+            g._dead_vertices = 0;
+            g._dead_edges    = 0;
+            std::vector<bool>().swap(g._removed);
+            assert(g.valid());
+        }
+
+        // -------
+        // reorder
+        // -------
+
+        /**
+         * Relabels the vertices of g in the order strategy gives, so that vertices
+         * a traversal visits together sit together in memory. Edges are renumbered
+         * in the new adjacency order, so rows, the edge list and edge properties
+         * are all laid out by new source. Each row keeps its edge order. Removed
+         * vertices and edges are dropped, as compact would.
+         * @param g         the graph to relabel, left unchanged
+         * @param strategy  the vertex order to use
+         * @returns         the relabeled graph with the old-to-new vertex and edge maps
+         */
+        friend reordering<basic_graph, Descriptor> reorder (const basic_graph& g, reorder_strategy strategy) {
+            std::vector<char> live(g.vertex_label);
+            for(vertex_descriptor v = 0; v < g.vertex_label; ++v)
+                live[v] = !g.removed(v);
+            const std::vector<std::size_t> order = graph_detail::vertex_order(graph_detail::out_csr(g), live, strategy);
+
+            reordering<basic_graph, Descriptor> r = {basic_graph(g._bidirectional ? bidirectional : directed),
+                std::vector<Descriptor>(g.vertex_label, vertex_descriptor(tombstone)),
+                std::vector<Descriptor>(g.edge_label, Descriptor(tombstone))};
+            for(std::size_t i = 0; i < order.size(); ++i)
+                r.vertex_map[order[i]] = i;
+
+            basic_graph& h = r.graph;
+            h._g.resize(order.size());
+            if(EdgeList)
+                h.edge_list.reserve(g.edge_label - g._dead_edges);
+            Descriptor ne = 0;
+            for(std::size_t i = 0; i < order.size(); ++i) {
+                const std::vector<out_edge>& row = g._g[order[i]];
+                std::vector<out_edge>&       moved = h._g[i];
+                moved.reserve(row.size());
+                for(typename std::vector<out_edge>::const_iterator it = row.begin(); it != row.end(); ++it) {
+                    if((*it).target == tombstone)
+                        continue;
+                    r.edge_map[(*it).edge_no] = ne;
+                    out_edge e = {ne++, r.vertex_map[(*it).target]};
+                    moved.push_back(e);
+                    if(EdgeList) {
+                        endpoints p = {vertex_descriptor(i), e.target};
+                        h.edge_list.push_back(p);
+                    }
+                }
+                if(moved.size() >= index_threshold)
+                    index_row(moved, h._hubs[i]);
+            }
+            if(g._bidirectional) {
+                h._in.resize(order.size());
+                for(std::size_t i = 0; i < order.size(); ++i) {
+                    for(typename std::vector<out_edge>::const_iterator it = h._g[i].begin(); it != h._g[i].end(); ++it) {
+                        in_edge e = {(*it).edge_no, vertex_descriptor(i)};
+                        h._in[(*it).target].push_back(e);
+                    }
+                }
+            }
+            h.vertex_label = order.size();
+            h.edge_label   = ne;
+            assert(h.valid());
+            return r;
+        }
+
+        // --------------
+        // sort_adjacency
+        // --------------
+
+        /**
+         * Sorts every out-edge row by target and every in-edge row by source, so
+         * adjacent_vertices and inv_adjacent_vertices run in ascending order and
+         * set intersections can use them as they are. Descriptors and edge numbers
+         * are unchanged, and hub indices are rebuilt for the new slots; add_edge
+         * appends, so later edges may break the order.
+         * @param g     the graph to sort
+         */
+        friend void sort_adjacency (basic_graph& g) {
+            graph_detail::parallel_for(g.vertex_label, [&g] (std::size_t b, std::size_t e) {
+                for(std::size_t v = b; v < e; ++v) {
+                    std::sort(g._g[v].begin(), g._g[v].end(), [] (const out_edge& x, const out_edge& y) {
+                        return x.target < y.target;});
+                    if(g._g[v].size() >= index_threshold)
+                        index_row(g._g[v], g._hubs.find(v)->second);
+                    if(g._bidirectional)
+                        std::sort(g._in[v].begin(), g._in[v].end(), [] (const in_edge& x, const in_edge& y) {
+                            return x.source < y.source;});
+                }}, 1024);
+        }
+
+        // ------
+        // source
+        // ------
+
+        /**
+         * Returns the source vertex of edge ed.
+         * @param   ed  the edge descriptor of the edge in question
+         * @param   g   the graph to look in
+         * @returns     the vertex descriptor of the source of the edge
+         */
+        friend vertex_descriptor source (edge_descriptor ed, const basic_graph& g) {
+            return g.source_of(ed);
+        }
+
+        // ------
+        // target
+        // ------
+
+        /**
+         * Returns the target vertex of edge ed.
+         * @param   ed  the edge descriptor of the edge in question
+         * @param   g   the graph to look in
+         * @returns     the vertex descriptor of the target of the edge
+         */
+        friend vertex_descriptor target (edge_descriptor ed, const basic_graph& g) {
+            return g.target_of(ed);
+        }
+
+        // ----------
+        // edge_index
+        // ----------
+
+        /**
+         * Returns the edge number of edge ed, a dense index for edge property maps.
+         * compact renumbers the edges, so it invalidates anything indexed by it.
+         * @param   ed  the edge descriptor of the edge in question
+         * @param   g   the graph to look in
+         * @returns     the edge number of ed, less than edge_index_bound(g)
+         */
+        friend edges_size_type edge_index (edge_descriptor ed, const basic_graph&) {
+            return edge_number(ed);
+        }
+
+        /**
+         * Returns one more than the largest edge number handed out so far; edges
+         * removed but not yet compacted still count.
+         * @param   g   the graph in question
+         * @returns     the size of an array indexed by edge_index
+         */
+        friend edges_size_type edge_index_bound (const basic_graph& g) {
+            return g.edge_label;
+        }
+
+        // ------------
+        // memory_usage
+        // ------------
+
+        /**
+         * Returns the bytes held by each internal structure of g.
+         * @param   g   the graph in question
+         * @returns     the breakdown, see graph_memory
+         */
+        friend graph_memory memory_usage (const basic_graph& g) {
+            graph_memory m;
+            m.adjacency = g._g.capacity() * sizeof(std::vector<out_edge>);
+            for(std::size_t v = 0; v < g._g.size(); ++v)
+                m.adjacency += g._g[v].capacity() * sizeof(out_edge);
+            m.in_edges = g._in.capacity() * sizeof(std::vector<in_edge>);
+            for(std::size_t v = 0; v < g._in.size(); ++v)
+                m.in_edges += g._in[v].capacity() * sizeof(in_edge);
+            m.edge_list = g.edge_list.capacity() * sizeof(endpoints);
+
+            // a hash node is a next pointer and the pair; an empty table allocates nothing
+            typedef std::unordered_map<vertex_descriptor, Descriptor> index_type;
+            m.hub_index = g._hubs.empty() ? 0 : g._hubs.bucket_count() * sizeof(void*) +
+                          g._hubs.size() * (sizeof(void*) + sizeof(std::pair<const vertex_descriptor, index_type>));
+            for(typename std::unordered_map<vertex_descriptor, index_type>::const_iterator it = g._hubs.begin(); it != g._hubs.end(); ++it)
+                m.hub_index += it->second.bucket_count() * sizeof(void*) +
+                               it->second.size() * (sizeof(void*) + sizeof(typename index_type::value_type));
+            m.removed = (g._removed.capacity() + 7) / 8;
+            return m;
+        }
+
+#ifdef GRAPH_STATS
+        // -----
+        // stats
+        // -----
+
+        /**
+         * Returns the hot-path counters of g. Only with GRAPH_STATS.
+         * @param   g   the graph in question
+         * @returns     its counters since it was made or last reset
+         */
+        friend const graph_stats& stats (const basic_graph& g) {
+            return g._stats;
+        }
+
+        /**
+         * Sets the hot-path counters of g to 0. Only with GRAPH_STATS.
+         * @param   g   the graph in question
+         */
+        friend void reset_stats (basic_graph& g) {
+            g._stats.reset();
+        }
+#endif
+
+        // ------
+        // vertex
+        // ------
+
+        /**
+         * Returns the nth vertex in the graph's vertex list.
+         * @param   n   the index of the vertex to return
+         * @param   g   the graph to look in
+         * @returns     the vertex descriptor of the nth vertex
+         */
+        friend vertex_descriptor vertex (vertices_size_type n, const basic_graph&) {
+            return n;
+        }
+
+        // --------
+        // vertices
+        // --------
+
+        /**
+         * Returns an iterator-range providing access to the vertex set of graph g.
+         * @param   g   the graph to look at
+         * @returns     a pair of iterators which encompass all vertices in g
+         */
+        friend std::pair<vertex_iterator, vertex_iterator> vertices (const basic_graph& g) {
+            return std::make_pair(vert_iter(&g,0), vert_iter(&g, g.vertex_label));
+        }
+
+        // ------
+        // freeze
+        // ------
+
+        template <typename D, bool L>
+        friend CompactGraph freeze (const basic_graph<D, L>& g);
+
+        // ------------------
+        // concurrent_builder
+        // ------------------
+
+        friend class concurrent_builder<Descriptor, EdgeList>;
+
+    private:
+        // -------
+        // storage
+        // -------
+
+        struct out_edge {
+            Descriptor          edge_no;
+            vertex_descriptor   target;
+        };
+
+        struct in_edge {
+            Descriptor          edge_no;
+            vertex_descriptor   source;
+        };
+
+        struct endpoints {
+            vertex_descriptor   source;
+            vertex_descriptor   target;
+        };
+
+        // ----
+        // data
+        // ----
+        std::vector< std::vector<out_edge> > _g;         //the 2d structure
+        vertex_descriptor vertex_label;                 //counter for vertex labels
+        Descriptor edge_label;                          //counter for edge labels
+        std::vector<endpoints> edge_list;               //endpoints by edge number, EdgeList only
+        std::unordered_map<vertex_descriptor, std::unordered_map<vertex_descriptor, Descriptor> > _hubs; //target to row slot of high degree vertices
+        bool _bidirectional;                            //whether _in is maintained
+        std::vector< std::vector<in_edge> > _in;        //in-edges of each vertex, bidirectional only
+        std::vector<bool> _removed;                     //removed vertices, empty until the first removal, then one per vertex
+        vertices_size_type _dead_vertices;              //removed vertices not yet compacted
+        edges_size_type _dead_edges;                    //removed edges not yet compacted
+
+        // ---------
+        // tombstone
+        // ---------
+
+        /**
+         * marks a removed edge: its target in _g and edge_list, its source in _in
+         */
+        static const vertex_descriptor tombstone = static_cast<vertex_descriptor>(-1);
+
+        // -------
+        // removed
+        // -------
+
+        /**
+         * @param vd    a vertex descriptor
+         * @returns     true if vd has been removed
+         */
+        bool removed (vertex_descriptor vd) const {
+            return _dead_vertices != 0 && _removed[vd];
+        }
+
+        // --------
+        // describe
+        // --------
+
+        /**
+         * builds the edge descriptor of edge number edge_no from vdS to vdT
+         */
+        static edge_descriptor describe (Descriptor edge_no, vertex_descriptor vdS, vertex_descriptor vdT) {
+            return describe(edge_no, vdS, vdT, std::integral_constant<bool, EdgeList>());
+        }
+
+        static Descriptor describe (Descriptor edge_no, vertex_descriptor, vertex_descriptor, std::true_type) {
+            return edge_no;
+        }
+
+        static edge describe (Descriptor edge_no, vertex_descriptor vdS, vertex_descriptor vdT, std::false_type) {
+            edge e = {edge_no, vdS, vdT};
+            return e;
+        }
+
+        // -----------
+        // edge_number
+        // -----------
+
+        /**
+         * @param ed    an edge descriptor
+         * @returns     the edge number of ed
+         */
+        static Descriptor edge_number (Descriptor ed) {
+            return ed;
+        }
+
+        static Descriptor edge_number (const edge& ed) {
+            return ed.edge_no;
+        }
+
+        // ---------
+        // source_of
+        // ---------
+
+        /**
+         * @param ed    an edge descriptor
+         * @returns     the source of ed, from the edge list or the descriptor itself
+         */
+        vertex_descriptor source_of (Descriptor ed) const {
+            return edge_list[ed].source;
+        }
+
+        vertex_descriptor source_of (const edge& ed) const {
+            return ed.source;
+        }
+
+        // ---------
+        // target_of
+        // ---------
+
+        /**
+         * @param ed    an edge descriptor
+         * @returns     the target of ed, from the edge list or the descriptor itself
+         */
+        vertex_descriptor target_of (Descriptor ed) const {
+            return edge_list[ed].target;
+        }
+
+        vertex_descriptor target_of (const edge& ed) const {
+            return ed.target;
+        }
+
+        // ----
+        // live
+        // ----
+
+        /**
+         * @param ed    an edge descriptor
+         * @returns     true if ed has not been removed
+         */
+        bool live (edge_descriptor ed) const {
+            if(target_of(ed) == tombstone)
+                return false;
+            std::pair<edge_descriptor, bool> found = find_edge(source_of(ed), target_of(ed));
+            return found.second && edge_number(found.first) == edge_number(ed);
+        }
+
+        // ---------
+        // kill_edge
+        // ---------
+
+        /**
+         * marks the live edge in slot of vdS's row dead in _g, _in and edge_list
+         * and drops it from the hub index. O(1), except that a bidirectional graph
+         * without in_slot scans the target's in-edges: O(in-degree).
+         * @param vdS       the vertex descriptor of its source
+         * @param slot      its position in _g[vdS]
+         * @param in_slot   its position in _in of its target, if the caller knows it
+         */
+        void kill_edge (vertex_descriptor vdS, std::size_t slot, std::size_t in_slot = std::size_t(-1)) {
+            std::vector<out_edge>& row = _g[vdS];
+            assert(slot < row.size() && row[slot].target != tombstone);
+            const Descriptor        edge_no = row[slot].edge_no;
+            const vertex_descriptor vdT     = row[slot].target;
+            row[slot].target = tombstone;
+            if(row.size() >= index_threshold)
+                _hubs[vdS].erase(vdT);
+            if(_bidirectional) {
+                std::vector<in_edge>& in = _in[vdT];
+                if(in_slot == std::size_t(-1)) {
+                    for(in_slot = 0; in[in_slot].edge_no != edge_no; ++in_slot)
+                        assert(in_slot + 1 < in.size());
+                }
+                assert(in[in_slot].edge_no == edge_no);
+                in[in_slot].source = tombstone;
+            }
+            if(EdgeList)
+                edge_list[edge_no].target = tombstone;
+            ++_dead_edges;
+        }
+
+        // ---------------
+        // index_threshold
+        // ---------------
+
+        /**
+         * out-degree at which a vertex gets a hashed target index;
+         * below it a linear scan of the adjacency list is faster
+         */
+        static const std::size_t index_threshold = 32;
+
+        // -----
+        // stats
+        // -----
+
+#ifdef GRAPH_STATS
+        mutable graph_stats _stats;                     //hot-path counters
+#endif
+
+        /**
+         * counts one call to a lookup that examined n entries
+         */
+        void count_probes (graph_stats::counter calls, std::size_t n) const {
+#ifdef GRAPH_STATS
+            if(calls != graph_stats::uncounted) {
+                _stats.add(calls, 1);
+                _stats.add(graph_stats::counter(calls + 1), n);
+            }
+#else
+            (void) calls;
+            (void) n;
+#endif
+        }
+
+        /**
+         * appends x to v, counting the reallocation if v is full
+         */
+        template <typename T>
+        void append (std::vector<T>& v, const T& x) {
+#ifdef GRAPH_STATS
+            if(v.size() == v.capacity()) {
+                _stats.add(graph_stats::reallocations, 1);
+                _stats.add(graph_stats::bytes_copied, v.size() * sizeof(T));
+            }
+#endif
+            v.push_back(x);
+        }
+
+        // ---------
+        // find_edge
+        // ---------
+
+        /**
+         * looks up edge (vdS,vdT) in O(1) for indexed vertices, O(d) otherwise
+         * @param vdS   the vertex descriptor of the source
+         * @param vdT   the vertex descriptor of the target
+         * @param calls the stats counter of the caller, or uncounted
+         * @returns     the edge's position in _g[vdS], or _g[vdS].size() if there is none
+         */
+        std::size_t find_slot (vertex_descriptor vdS, vertex_descriptor vdT,
+                               graph_stats::counter calls = graph_stats::uncounted) const {
+            const std::vector<out_edge>& row = _g[vdS];
+            if(row.size() >= index_threshold) {
+                const std::unordered_map<vertex_descriptor, Descriptor>& index = _hubs.find(vdS)->second;
+                typename std::unordered_map<vertex_descriptor, Descriptor>::const_iterator it = index.find(vdT);
+                count_probes(calls, 1);
+                return it == index.end() ? row.size() : std::size_t(it->second);
+            }
+            for(typename std::vector<out_edge>::const_iterator it = row.begin(); it != row.end(); ++it) {
+                if((*it).target == vdT) {
+                    count_probes(calls, it - row.begin() + 1);
+                    return it - row.begin();
+                }
+            }
+            count_probes(calls, row.size());
+            return row.size();
+        }
+
+        /**
+         * find_slot as an edge descriptor
+         * @returns     a pair with the edge descriptor and whether it was found
+         */
+        std::pair<edge_descriptor, bool> find_edge (vertex_descriptor vdS, vertex_descriptor vdT,
+                                                    graph_stats::counter calls = graph_stats::uncounted) const {
+            const std::size_t slot = find_slot(vdS, vdT, calls);
+            if(slot == _g[vdS].size())
+                return std::make_pair(describe(0, vdS, vdT), false);
+            return std::make_pair(describe(_g[vdS][slot].edge_no, vdS, vdT), true);
+        }
+
+        // ---------
+        // index_row
+        // ---------
+
+        /**
+         * rebuilds index to map the target of every live edge of row to its slot
+         */
+        static void index_row (const std::vector<out_edge>& row, std::unordered_map<vertex_descriptor, Descriptor>& index) {
+            index.clear();
+            index.reserve(row.size() > 2 * index_threshold ? row.size() : 2 * index_threshold);
+            for(std::size_t i = 0; i < row.size(); ++i) {
+                if(row[i].target != tombstone)
+                    index.insert(std::make_pair(row[i].target, Descriptor(i)));
+            }
+        }
+
+        // -----------
+        // append_edge
+        // -----------
+
+        /**
+         * appends edge (vdS,vdT) without checking for duplicates, indexing vdS
+         * once its out-degree reaches index_threshold
+         * @param vdS   the vertex descriptor of the source
+         * @param vdT   the vertex descriptor of the target
+         * @returns     the edge descriptor of the new edge
+         */
+        edge_descriptor append_edge (vertex_descriptor vdS, vertex_descriptor vdT) {
+            assert(edge_label < Descriptor(tombstone));
+            Descriptor ed = edge_label++;
+            out_edge out = {ed, vdT};
+            std::vector<out_edge>& row = _g[vdS];
+            append(row, out);
+            if(EdgeList) {
+                endpoints e = {vdS, vdT};
+                append(edge_list, e);
+            }
+            if(_bidirectional) {
+                in_edge in = {ed, vdS};
+                append(_in[vdT], in);
+            }
+
+            if(row.size() > index_threshold)
+                _hubs[vdS].insert(std::make_pair(vdT, Descriptor(row.size() - 1)));
+            else if(row.size() == index_threshold)
+                index_row(row, _hubs[vdS]);
+            return describe(ed, vdS, vdT);
+        }
+
+        // -----
+        // valid
+        // -----
+
+        /**
+         * private function to test validity of a constructed graph
+         * @returns     true if valid
+         */
+        bool valid () const {
+            return vertex_label >= 0 && edge_label >= 0 && (_bidirectional || _in.empty()) &&
+                   (EdgeList || edge_list.empty()) &&
+                   _dead_vertices <= vertex_label && _dead_edges <= edge_label;
+        }
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * A simple graph implementation based on boost's adjacency_list.
+         * Constructs a new graph with no edges or vertices
+         */
+        basic_graph () {
+            vertex_label = 0;
+            edge_label = 0;
+            _bidirectional = false;
+            _dead_vertices = 0;
+            _dead_edges = 0;
+            assert(valid());
+        }
+
+        /**
+         * Constructs a new graph with no edges or vertices that keeps in-edges
+         * when d is bidirectional
+         * @param d     directed or bidirectional
+         */
+        explicit basic_graph (direction d) {
+            vertex_label = 0;
+            edge_label = 0;
+            _bidirectional = (d == bidirectional);
+            _dead_vertices = 0;
+            _dead_edges = 0;
+            assert(valid());
+        }
+
+        // Default copy, destructor, and copy assignment
+        // basic_graph  (const basic_graph&);
+        // ~basic_graph ();
+        // basic_graph& operator = (const basic_graph&);
+    };
+
+template <typename Descriptor, bool EdgeList>
+const Descriptor basic_graph<Descriptor, EdgeList>::tombstone;
+
+template <typename Descriptor, bool EdgeList>
+const std::size_t basic_graph<Descriptor, EdgeList>::index_threshold;
+
+/**
+ * the default graph: std::size_t descriptors and an edge list
+ */
+typedef basic_graph<> Graph;
+
+// ------------------
+// concurrent_builder
+// ------------------
+
+/**
+ * Builds a basic_graph from many threads at once. add_vertex and add_edge may be
+ * called concurrently from any number of threads:
+ * - vertices live in a segmented array, so adding one never moves another;
+ * - each source vertex's row is guarded by one of a fixed set of striped locks,
+ *   so threads only wait for each other when their sources share a stripe;
+ * - edge numbers come from an atomic counter, so they are dense but, across
+ *   threads, in no particular order.
+ * Rows index their targets once they reach the graph's index_threshold, just as
+ * basic_graph does. finish moves everything into a basic_graph in O(V + E).
+ */
+template <typename Descriptor, bool EdgeList>
+class concurrent_builder {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef basic_graph<Descriptor, EdgeList>      graph_type;
+        typedef typename graph_type::vertex_descriptor vertex_descriptor;
+        typedef typename graph_type::edge_descriptor   edge_descriptor;
+        typedef std::size_t                            vertices_size_type;
+        typedef std::size_t                            edges_size_type;
+
+    private:
+        typedef typename graph_type::out_edge                      out_edge;
+        typedef typename graph_type::endpoints                     endpoints;
+        typedef std::unordered_map<vertex_descriptor, Descriptor>  index_type;
+
+        /**
+         * the out-edges of one vertex, and their target index once it has many
+         */
+        struct row {
+            std::vector<out_edge>       edges;
+            std::unique_ptr<index_type> index;
+        };
+
+        /**
+         * a lock on its own cache line, so neighbouring stripes do not contend
+         */
+        struct alignas(64) stripe {
+            std::mutex lock;
+        };
+
+        static const std::size_t stripes = 512;
+
+        // ----
+        // data
+        // ----
+        graph_detail::segmented_array<row>       _rows;          //the rows, by vertex
+        graph_detail::segmented_array<endpoints> _ends;          //the endpoints, by edge number, if finish needs them
+        std::atomic<std::size_t>                 _vertex_count;  //counter for vertex labels
+        std::atomic<std::size_t>                 _edge_count;    //counter for edge labels
+        bool                                     _bidirectional; //whether finish builds in-edges
+        stripe                                   _stripes[stripes];
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * Constructs a builder with no vertices or edges.
+         * @param d     whether finish makes a directed or bidirectional graph
+         */
+        explicit concurrent_builder (typename graph_type::direction d = graph_type::directed) :
+            _bidirectional(d == graph_type::bidirectional)
+        {
+            _vertex_count.store(0, std::memory_order_relaxed);
+            _edge_count.store(0, std::memory_order_relaxed);
+        }
+
+        // ----------
+        // add_vertex
+        // ----------
+
+        /**
+         * Adds a vertex and returns its descriptor. Safe to call from several threads.
+         * @param b     the builder to add a vertex to
+         * @returns     the vertex_descriptor of the added vertex
+         */
+        friend vertex_descriptor add_vertex (concurrent_builder& b) {
+            return b.push_vertex();
+        }
+
+        // --------
+        // add_edge
+        // --------
+
+        /**
+         * Adds edge (vdS,vdT) unless it is already there. Safe to call from several
+         * threads; both vertices must have been returned by add_vertex before the
+         * call, in this thread or one that synchronized with it.
+         * @param vdS   the vertex descriptor of the source
+         * @param vdT   the vertex descriptor of the target
+         * @param b     the builder to add the edge to
+         * @returns     a pair with the edge descriptor and a boolean indicating whether or
+         *              not an edge was added
+         */
+        friend std::pair<edge_descriptor, bool> add_edge (vertex_descriptor vdS, vertex_descriptor vdT, concurrent_builder& b) {
+            return b.insert(vdS, vdT);
+        }
+
+        // ------------
+        // num_vertices
+        // ------------
+
+        /**
+         * @param   b   the builder in question
+         * @returns     the number of vertices added so far
+         */
+        friend vertices_size_type num_vertices (const concurrent_builder& b) {
+            return b._vertex_count.load(std::memory_order_relaxed);
+        }
+
+        // ---------
+        // num_edges
+        // ---------
+
+        /**
+         * @param   b   the builder in question
+         * @returns     the number of edges added so far
+         */
+        friend edges_size_type num_edges (const concurrent_builder& b) {
+            return b._edge_count.load(std::memory_order_relaxed);
+        }
+
+        // ------
+        // finish
+        // ------
+
+        /**
+         * Moves the vertices and edges of b into a new graph and leaves b empty.
+         * Every add_vertex and add_edge call must have returned first.
+         * Descriptors returned by b are valid in the graph.
+         * @param   b   the builder to empty
+         * @returns     the built graph
+         */
+        friend graph_type finish (concurrent_builder& b) {
+            return b.build();
+        }
+
+    private:
+        // -----------
+        // push_vertex
+        // -----------
+
+        /**
+         * the body of add_vertex
+         */
+        vertex_descriptor push_vertex () {
+            const std::size_t vd = _vertex_count.fetch_add(1, std::memory_order_relaxed);
+            assert(vd < vertex_descriptor(graph_type::tombstone));
+            _rows.ensure(vd);
+            return vd;
+        }
+
+        // ------
+        // insert
+        // ------
+
+        /**
+         * the body of add_edge: holds vdS's stripe while it searches and appends to vdS's row
+         */
+        std::pair<edge_descriptor, bool> insert (vertex_descriptor vdS, vertex_descriptor vdT) {
+            assert(vdS < _vertex_count.load(std::memory_order_relaxed));
+            assert(vdT < _vertex_count.load(std::memory_order_relaxed));
+            row& r = _rows[vdS];
+            std::lock_guard<std::mutex> lock(_stripes[vdS % stripes].lock);
+
+            if(r.index) {
+                typename index_type::const_iterator it = r.index->find(vdT);
+                if(it != r.index->end())
+                    return std::make_pair(graph_type::describe(r.edges[it->second].edge_no, vdS, vdT), false);
+            }
+            else {
+                for(typename std::vector<out_edge>::const_iterator it = r.edges.begin(); it != r.edges.end(); ++it) {
+                    if((*it).target == vdT)
+                        return std::make_pair(graph_type::describe((*it).edge_no, vdS, vdT), false);
+                }
+            }
+
+            const std::size_t ed = _edge_count.fetch_add(1, std::memory_order_relaxed);
+            assert(ed < Descriptor(graph_type::tombstone));
+            if(EdgeList || _bidirectional) {
+                _ends.ensure(ed);
+                endpoints e = {vdS, vdT};
+                _ends[ed] = e;
+            }
+            out_edge out = {Descriptor(ed), vdT};
+            r.edges.push_back(out);
+            if(r.index)
+                r.index->insert(std::make_pair(vdT, Descriptor(r.edges.size() - 1)));
+            else if(r.edges.size() == graph_type::index_threshold) {
+                r.index.reset(new index_type());
+                graph_type::index_row(r.edges, *r.index);
+            }
+            return std::make_pair(graph_type::describe(ed, vdS, vdT), true);
+        }
+
+        // -----
+        // build
+        // -----
+
+        /**
+         * the body of finish
+         */
+        graph_type build () {
+            const std::size_t n = _vertex_count.load(std::memory_order_acquire);
+            const std::size_t m = _edge_count.load(std::memory_order_acquire);
+            graph_type g(_bidirectional ? graph_type::bidirectional : graph_type::directed);
+
+            g._g.resize(n);
+            for(std::size_t v = 0; v < n; ++v) {
+                row& r = _rows[v];
+                g._g[v].swap(r.edges);
+                if(r.index)
+                    g._hubs[v].swap(*r.index);
+            }
+            if(EdgeList) {
+                g.edge_list.resize(m);
+                for(std::size_t ed = 0; ed < m; ++ed)
+                    g.edge_list[ed] = _ends[ed];
+            }
+            if(_bidirectional) {
+                g._in.resize(n);
+                for(std::size_t ed = 0; ed < m; ++ed) {
+                    typename graph_type::in_edge in = {Descriptor(ed), _ends[ed].source};
+                    g._in[_ends[ed].target].push_back(in);
+                }
+            }
+            g.vertex_label = n;
+            g.edge_label   = m;
+
+            _rows.clear();
+            _ends.clear();
+            _vertex_count.store(0, std::memory_order_relaxed);
+            _edge_count.store(0, std::memory_order_relaxed);
+            assert(g.valid());
+            return g;
+        }
+
+        concurrent_builder (const concurrent_builder&);
+        concurrent_builder& operator = (const concurrent_builder&);
+};
+
+// --------------
+// graph_snapshot
+// --------------
+
+/**
+ * A read-only view of a versioned_graph as it was when snapshot took it: the
+ * first num_vertices vertices and num_edges edges, whatever has been added since.
+ * Taking one is O(1) and reading one takes no lock, so readers can run any of the
+ * algorithms here on a snapshot while writers keep adding to the graph. A
+ * snapshot must not outlive its graph.
+ */
+template <typename Descriptor>
+class graph_snapshot {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef Descriptor      vertex_descriptor;
+        typedef Descriptor      edge_descriptor;
+
+        class vert_iter;
+        class edge_iter;
+        class adj_iter;
+
+        typedef vert_iter       vertex_iterator;
+        typedef edge_iter       edge_iterator;
+        typedef adj_iter        adjacency_iterator;
+
+        typedef std::size_t     vertices_size_type;
+        typedef std::size_t     edges_size_type;
+        typedef std::size_t     degree_size_type;
+
+    private:
+        typedef graph_detail::append_row<Descriptor> row;
+
+        struct endpoints {
+            vertex_descriptor source;
+            vertex_descriptor target;
+        };
+
+    public:
+
+    /**
+     * vertex iterator
+     * will iterate over every vertex in the snapshot
+     */
+    class vert_iter {
+      private:
+        std::size_t index;
+
+      public:
+        /**
+         * checks to see if the lhs == rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  true if the lhs and rhs point to the same value
+         */
+        friend bool operator == (const vert_iter& lhs, const vert_iter& rhs) {
+            return lhs.index == rhs.index;
+        }
+
+        /**
+         * checks to see if the lhs != rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  false if the lhs and rhs point to the same value
+         */
+        friend bool operator != (const vert_iter& lhs, const vert_iter& rhs) {
+            return !(lhs == rhs);
+        }
+
+        /**
+         * creates a new vertex iterator
+         * @param   vd the index of this iterator
+         */
+        explicit vert_iter(std::size_t vd) :
+            index(vd)
+        {}
+
+        /**
+         * dereference this iterator
+         * @returns the value at which this iterator is pointing
+         */
+        vertex_descriptor operator * () const {
+            return index;
+        }
+
+        /**
+         * (pre)increment this iterator
+         * @returns this with its new value
+         */
+        vert_iter& operator ++ () {
+            ++index;
+            return *this;
+        }
+    };
+
+    /**
+     * edge iterator
+     * will iterate over every edge in the snapshot in edge descriptor order
+     */
+    class edge_iter {
+      private:
+        std::size_t index;
+
+      public:
+        /**
+         * checks to see if the lhs == rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  true if the lhs and rhs point to the same value
+         */
+        friend bool operator == (const edge_iter& lhs, const edge_iter& rhs) {
+            return lhs.index == rhs.index;
+        }
+
+        /**
+         * checks to see if the lhs != rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  false if the lhs and rhs point to the same value
+         */
+        friend bool operator != (const edge_iter& lhs, const edge_iter& rhs) {
+            return !(lhs == rhs);
+        }
+
+        /**
+         * creates a new edge iterator
+         * @param   ed the index of this iterator
+         */
+        explicit edge_iter(std::size_t ed) :
+            index(ed)
+        {}
+
+        /**
+         * dereference this iterator
+         * @returns the value at which this iterator is pointing
+         */
+        edge_descriptor operator * () const {
+            return index;
+        }
+
+        /**
+         * (pre)increment this iterator
+         * @returns this with its new value
+         */
+        edge_iter& operator ++ () {
+            ++index;
+            return *this;
+        }
+    };
+
+    /**
+     * adjacent vertex iterator
+     * walks one row's chunks, stopping at the first edge added after the snapshot
+     */
+    class adj_iter {
+      private:
+        const typename row::chunk *c;
+        std::size_t index;          //position in c
+        std::size_t left;           //published entries from here on, 0 once done
+        std::size_t bound;          //the snapshot's num_edges
+
+        /**
+         * ends the walk at an edge the snapshot does not have
+         */
+        void check () {
+            if(left != 0 && c->entries[index].edge_no >= bound)
+                left = 0;
+        }
+
+      public:
+        /**
+         * checks to see if the lhs == rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  true if the lhs and rhs point to the same value
+         */
+        friend bool operator == (const adj_iter& lhs, const adj_iter& rhs) {
+            return lhs.left == rhs.left && (lhs.left == 0 || (lhs.c == rhs.c && lhs.index == rhs.index));
+        }
+
+        /**
+         * checks to see if the lhs != rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  false if the lhs and rhs point to the same value
+         */
+        friend bool operator != (const adj_iter& lhs, const adj_iter& rhs) {
+            return !(lhs == rhs);
+        }
+
+        /**
+         * creates a new adjacent vertex iterator
+         * @param   r   the row to walk, or 0 for the end of any row
+         * @param   b   the snapshot's num_edges
+         */
+        adj_iter(const row *r, std::size_t b) :
+            c(0),
+            index(0),
+            left(r == 0 ? 0 : r->size.load(std::memory_order_acquire)),
+            bound(b)
+        {
+            if(left != 0)
+                c = r->first;
+            check();
+        }
+
+        /**
+         * dereference this iterator
+         * @returns the value at which this iterator is pointing
+         */
+        vertex_descriptor operator * () const {
+            return c->entries[index].target;
+        }
+
+        /**
+         * (pre)increment this iterator
+         * @returns this with its new value
+         */
+        adj_iter& operator ++ () {
+            --left;
+            if(left != 0 && ++index == c->capacity) {
+                c     = c->next;
+                index = 0;
+            }
+            check();
+            return *this;
+        }
+    };
+
+    private:
+        // ----
+        // data
+        // ----
+        graph_detail::segmented_array<row>       *_rows;        //the graph's rows
+        graph_detail::segmented_array<endpoints> *_ends;        //the graph's endpoints, by edge number
+        std::size_t                               _vertices;    //the graph's num_vertices when taken
+        std::size_t                               _edges;       //the graph's num_edges when taken
+
+        friend class versioned_graph<Descriptor>;
+
+        graph_snapshot (graph_detail::segmented_array<row> *rows, graph_detail::segmented_array<endpoints> *ends,
+                        std::size_t vertices, std::size_t edges) :
+            _rows(rows),
+            _ends(ends),
+            _vertices(vertices),
+            _edges(edges)
+        {}
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * Constructs an empty snapshot of no graph.
+         */
+        graph_snapshot () :
+            _rows(0),
+            _ends(0),
+            _vertices(0),
+            _edges(0)
+        {}
+
+        // ------------
+        // num_vertices
+        // ------------
+
+        /**
+         * @param   s   the snapshot in question
+         * @returns     the number of vertices in s
+         */
+        friend vertices_size_type num_vertices (const graph_snapshot& s) {
+            return s._vertices;
+        }
+
+        // ---------
+        // num_edges
+        // ---------
+
+        /**
+         * @param   s   the snapshot in question
+         * @returns     the number of edges in s
+         */
+        friend edges_size_type num_edges (const graph_snapshot& s) {
+            return s._edges;
+        }
+
+        // --------
+        // vertices
+        // --------
+
+        /**
+         * @param   s   the snapshot in question
+         * @returns     a pair of vertex iterators over every vertex of s
+         */
+        friend std::pair<vertex_iterator, vertex_iterator> vertices (const graph_snapshot& s) {
+            return std::make_pair(vertex_iterator(0), vertex_iterator(s._vertices));
+        }
+
+        // -----
+        // edges
+        // -----
+
+        /**
+         * @param   s   the snapshot in question
+         * @returns     a pair of edge iterators over every edge of s
+         */
+        friend std::pair<edge_iterator, edge_iterator> edges (const graph_snapshot& s) {
+            return std::make_pair(edge_iterator(0), edge_iterator(s._edges));
+        }
+
+        // -----------------
+        // adjacent_vertices
+        // -----------------
+
+        /**
+         * @param   vd  a vertex of s
+         * @param   s   the snapshot in question
+         * @returns     a pair of adjacency iterators over the targets of vd's out-edges in s
+         */
+        friend std::pair<adjacency_iterator, adjacency_iterator> adjacent_vertices (vertex_descriptor vd, const graph_snapshot& s) {
+            assert(vd < s._vertices);
+            return std::make_pair(adjacency_iterator(&(*s._rows)[vd], s._edges), adjacency_iterator(0, s._edges));
+        }
+
+        // ----
+        // edge
+        // ----
+
+        /**
+         * Looks for edge (vdS,vdT) in O(out-degree of vdS); there is no lock-free hub index.
+         * @param vdS   the vertex descriptor of the source
+         * @param vdT   the vertex descriptor of the target
+         * @param s     the snapshot to look in
+         * @returns     a pair with the edge descriptor and whether s has the edge
+         */
+        friend std::pair<edge_descriptor, bool> edge (vertex_descriptor vdS, vertex_descriptor vdT, const graph_snapshot& s) {
+            assert(vdS < s._vertices);
+            const row&                 r = (*s._rows)[vdS];
+            const std::size_t          n = r.size.load(std::memory_order_acquire);
+            const typename row::chunk *c = r.first;
+            for(std::size_t i = 0, k = 0; i < n; ++i, ++k) {
+                if(k == c->capacity) {
+                    c = c->next;
+                    k = 0;
+                }
+                const typename row::entry& e = c->entries[k];
+                if(e.edge_no >= s._edges)
+                    break;
+                if(e.target == vdT)
+                    return std::make_pair(e.edge_no, true);
+            }
+            return std::make_pair(edge_descriptor(0), false);
+        }
+
+        // ------
+        // source
+        // ------
+
+        /**
+         * @param   ed  an edge of s
+         * @param   s   the snapshot to look in
+         * @returns     the source vertex of ed
+         */
+        friend vertex_descriptor source (edge_descriptor ed, const graph_snapshot& s) {
+            assert(ed < s._edges);
+            return (*s._ends)[ed].source;
+        }
+
+        // ------
+        // target
+        // ------
+
+        /**
+         * @param   ed  an edge of s
+         * @param   s   the snapshot to look in
+         * @returns     the target vertex of ed
+         */
+        friend vertex_descriptor target (edge_descriptor ed, const graph_snapshot& s) {
+            assert(ed < s._edges);
+            return (*s._ends)[ed].target;
+        }
+
+        // ----------
+        // edge_index
+        // ----------
+
+        /**
+         * @param   ed  an edge of s
+         * @returns     the edge number of ed, less than edge_index_bound(s)
+         */
+        friend edges_size_type edge_index (edge_descriptor ed, const graph_snapshot&) {
+            return ed;
+        }
+
+        /**
+         * @param   s   the snapshot in question
+         * @returns     the size of an array indexed by edge_index
+         */
+        friend edges_size_type edge_index_bound (const graph_snapshot& s) {
+            return s._edges;
+        }
+};
+
+// ---------------
+// versioned_graph
+// ---------------
+
+/**
+ * An append-only graph for mixed workloads: writers add vertices and edges while
+ * readers work on snapshots. Rows are append_rows and endpoints live in a
+ * segmented_array, so nothing a reader can see ever moves or changes; an edge
+ * is written first and published by one release store of the edge count, and
+ * snapshot takes the vertex and edge counts with acquire loads. Writers are
+ * serialized by one mutex and deduplicate edges by scanning the row or, from
+ * index_threshold out-edges on, through a writer-only hub index. There is no
+ * removal.
+ */
+template <typename Descriptor>
+class versioned_graph {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef Descriptor      vertex_descriptor;
+        typedef Descriptor      edge_descriptor;
+        typedef std::size_t     vertices_size_type;
+        typedef std::size_t     edges_size_type;
+
+        typedef graph_snapshot<Descriptor> snapshot_type;
+
+    private:
+        typedef graph_detail::append_row<Descriptor>               row;
+        typedef typename snapshot_type::endpoints                  endpoints;
+        typedef std::unordered_map<vertex_descriptor, Descriptor>  index_type;
+
+        static const std::size_t index_threshold = 32;
+
+        // ----
+        // data
+        // ----
+        graph_detail::segmented_array<row>       _rows;          //the rows, by vertex
+        graph_detail::segmented_array<endpoints> _ends;          //the endpoints, by edge number
+        std::atomic<std::size_t>                 _vertex_count;  //vertices published to snapshots
+        std::atomic<std::size_t>                 _edge_count;    //edges published to snapshots
+        std::unordered_map<vertex_descriptor, index_type> _hubs; //target index of high degree vertices, writer only
+        std::mutex                               _write;         //held by add_vertex and add_edge
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * Constructs an empty graph.
+         */
+        versioned_graph () {
+            _vertex_count.store(0, std::memory_order_relaxed);
+            _edge_count.store(0, std::memory_order_relaxed);
+        }
+
+        // ----------
+        // add_vertex
+        // ----------
+
+        /**
+         * Adds a vertex; snapshots taken from now on include it.
+         * @param g     the graph to add a vertex to
+         * @returns     the vertex_descriptor of the added vertex
+         */
+        friend vertex_descriptor add_vertex (versioned_graph& g) {
+            return g.push_vertex();
+        }
+
+        // --------
+        // add_edge
+        // --------
+
+        /**
+         * Adds edge (vdS,vdT) unless it is already there; snapshots taken from now
+         * on include it.
+         * @param vdS   the vertex descriptor of the source
+         * @param vdT   the vertex descriptor of the target
+         * @param g     the graph to add the edge to
+         * @returns     a pair with the edge descriptor and a boolean indicating whether or
+         *              not an edge was added
+         */
+        friend std::pair<edge_descriptor, bool> add_edge (vertex_descriptor vdS, vertex_descriptor vdT, versioned_graph& g) {
+            return g.insert(vdS, vdT);
+        }
+
+        // ------------
+        // num_vertices
+        // ------------
+
+        /**
+         * @param   g   the graph in question
+         * @returns     the number of vertices added so far
+         */
+        friend vertices_size_type num_vertices (const versioned_graph& g) {
+            return g._vertex_count.load(std::memory_order_acquire);
+        }
+
+        // ---------
+        // num_edges
+        // ---------
+
+        /**
+         * @param   g   the graph in question
+         * @returns     the number of edges added so far
+         */
+        friend edges_size_type num_edges (const versioned_graph& g) {
+            return g._edge_count.load(std::memory_order_acquire);
+        }
+
+        // --------
+        // snapshot
+        // --------
+
+        /**
+         * Takes a consistent view of g in O(1), without a lock or a copy. Safe to
+         * call from any thread, alongside add_vertex and add_edge.
+         * @param   g   the graph to view
+         * @returns     a snapshot of every vertex and edge added to g so far
+         */
+        friend snapshot_type snapshot (versioned_graph& g) {
+            return g.take_snapshot();
+        }
+
+    private:
+        // -----------
+        // push_vertex
+        // -----------
+
+        /**
+         * the body of add_vertex
+         */
+        vertex_descriptor push_vertex () {
+            std::lock_guard<std::mutex> lock(_write);
+            const std::size_t vd = _vertex_count.load(std::memory_order_relaxed);
+            assert(vd < std::size_t(std::numeric_limits<Descriptor>::max()));
+            _rows.ensure(vd);
+            _vertex_count.store(vd + 1, std::memory_order_release);
+            return vd;
+        }
+
+        // ------
+        // insert
+        // ------
+
+        /**
+         * the body of add_edge
+         */
+        std::pair<edge_descriptor, bool> insert (vertex_descriptor vdS, vertex_descriptor vdT) {
+            std::lock_guard<std::mutex> lock(_write);
+            assert(vdS < _vertex_count.load(std::memory_order_relaxed));
+            assert(vdT < _vertex_count.load(std::memory_order_relaxed));
+            row& r = _rows[vdS];
+            const std::size_t n = r.size.load(std::memory_order_relaxed);
+            if(n >= index_threshold) {
+                const index_type& index = _hubs[vdS];
+                typename index_type::const_iterator it = index.find(vdT);
+                if(it != index.end())
+                    return std::make_pair(it->second, false);
+            }
+            else {
+                const typename row::chunk *c = r.first;
+                for(std::size_t i = 0, k = 0; i < n; ++i, ++k) {
+                    if(k == c->capacity) {
+                        c = c->next;
+                        k = 0;
+                    }
+                    if(c->entries[k].target == vdT)
+                        return std::make_pair(c->entries[k].edge_no, false);
+                }
+            }
+
+            const std::size_t ed = _edge_count.load(std::memory_order_relaxed);
+            assert(ed < std::size_t(std::numeric_limits<Descriptor>::max()));
+            _ends.ensure(ed);
+            endpoints e = {vdS, vdT};
+            _ends[ed]   = e;
+            typename row::entry out = {Descriptor(ed), vdT};
+            r.push_back(out);
+
+            if(n + 1 > index_threshold)
+                _hubs[vdS].insert(std::make_pair(vdT, Descriptor(ed)));
+            else if(n + 1 == index_threshold) {
+                index_type& index = _hubs[vdS];
+                index.reserve(2 * index_threshold);
+                const typename row::chunk *c = r.first;
+                for(std::size_t i = 0, k = 0; i <= n; ++i, ++k) {
+                    if(k == c->capacity) {
+                        c = c->next;
+                        k = 0;
+                    }
+                    index.insert(std::make_pair(c->entries[k].target, c->entries[k].edge_no));
+                }
+            }
+            _edge_count.store(ed + 1, std::memory_order_release);
+            return std::make_pair(Descriptor(ed), true);
+        }
+
+        // -------------
+        // take_snapshot
+        // -------------
+
+        /**
+         * the body of snapshot: the edge count first, so every vertex an edge
+         * of the snapshot touches is in it too
+         */
+        snapshot_type take_snapshot () {
+            const std::size_t edges    = _edge_count.load(std::memory_order_acquire);
+            const std::size_t vertices = _vertex_count.load(std::memory_order_acquire);
+            return snapshot_type(&_rows, &_ends, vertices, edges);
+        }
+
+        versioned_graph (const versioned_graph&);
+        versioned_graph& operator = (const versioned_graph&);
+};
+
+// ------------
+// CompactGraph
+// ------------
+
+/**
+ * A read-optimized graph stored in compressed sparse row (CSR) form.
+ * The targets of every vertex's out-edges are packed into one contiguous array,
+ * delimited by a per-vertex offsets array, so adjacency iteration is a pointer walk.
+ * Each row is sorted by target, so edge() is a binary search.
+ * Edge descriptors are kept identical to those of the Graph it was frozen from.
+ * The arrays are either owned or, after map_graph, read in place from a mapped file.
+ */
+class CompactGraph {
     public:
-    
+
     /**
-     * vertex iterator 
+     * vertex iterator
      * will iterate over every vertex in the graph
      */
     class vert_iter {
       private:
         std::size_t index;
-        const Graph *owner;
-        
+
       public:
         /**
          * checks to see if the lhs == rhs
@@ -40,9 +3666,9 @@ class Graph {
          * @return  true if the lhs and rhs point to the same value
          */
         friend bool operator == (const vert_iter& lhs, const vert_iter& rhs) {
-            return (lhs.owner == rhs.owner) && (lhs.index == rhs.index);;
+            return lhs.index == rhs.index;
         }
-        
+
         /**
          * checks to see if the lhs != rhs
          * @param   lhs the left hand side in question
@@ -52,27 +3678,23 @@ class Graph {
         friend bool operator != (const vert_iter& lhs, const vert_iter& rhs) {
             return !(lhs == rhs);
         }
-        
+
         /**
          * creates a new vertex iterator
-         * @param   *owner the graph from which this iterator represents
          * @param   ed the index of this iterator
          */
-        vert_iter(const Graph *owner_, std::size_t ed) :
-            index(ed),
-            owner(owner_)
-        {
-            assert(ed >= 0);
-        }
-        
+        explicit vert_iter(std::size_t ed) :
+            index(ed)
+        {}
+
         /**
          * dereference this iterator
          * @returns the value at which this iterator is pointing
          */
-        int operator * () const {
+        std::size_t operator * () const {
             return index;
         }
-        
+
         /**
          * (pre)increment this iterator
          * @returns this with its new value
@@ -82,16 +3704,15 @@ class Graph {
             return *this;
         }
     };
-    
+
     /**
      * edge iterator
-     * will iterate over every edge in the graph
+     * will iterate over every edge in the graph in edge descriptor order
      */
     class edge_iter {
       private:
         std::size_t index;
-        const Graph *owner;
-        
+
       public:
         /**
          * checks to see if the lhs == rhs
@@ -100,9 +3721,9 @@ class Graph {
          * @return  true if the lhs and rhs point to the same value
          */
         friend bool operator == (const edge_iter& lhs, const edge_iter& rhs) {
-            return (lhs.owner == rhs.owner) && (lhs.index == rhs.index);;
+            return lhs.index == rhs.index;
         }
-        
+
         /**
          * checks to see if the lhs != rhs
          * @param   lhs the left hand side in question
@@ -112,27 +3733,23 @@ class Graph {
         friend bool operator != (const edge_iter& lhs, const edge_iter& rhs) {
             return !(lhs == rhs);
         }
-        
+
         /**
          * creates a new edge iterator
-         * @param   *owner the graph from which this iterator represents
          * @param   ed the index of this iterator
          */
-        edge_iter(const Graph *owner_, std::size_t ed) :
-            index(ed),
-            owner(owner_)
-        {
-            assert(ed >= 0);
-        }
-        
+        explicit edge_iter(std::size_t ed) :
+            index(ed)
+        {}
+
         /**
          * dereference this iterator
          * @returns the value at which this iterator is pointing
          */
-        int operator * () const {
-            return owner->edge_list[index].edge_no;
+        std::size_t operator * () const {
+            return index;
         }
-        
+
         /**
          * (pre)increment this iterator
          * @returns this with its new value
@@ -142,17 +3759,15 @@ class Graph {
             return *this;
         }
     };
-    
+
     /**
-     * adjacent vertece iterator
-     * will iterate over every vertex in the graph that has an edge from given vertex
+     * adjacent vertex iterator
+     * walks the packed target array of a single vertex
      */
     class adj_iter {
       private:
-        int vertex;
-        std::size_t index;
-        const Graph *owner;
-        
+        const std::size_t *pos;
+
       public:
         /**
          * checks to see if the lhs == rhs
@@ -161,9 +3776,9 @@ class Graph {
          * @return  true if the lhs and rhs point to the same value
          */
         friend bool operator == (const adj_iter& lhs, const adj_iter& rhs) {
-            return (lhs.owner == rhs.owner) && (lhs.index == rhs.index) && (lhs.vertex == rhs.vertex);
+            return lhs.pos == rhs.pos;
         }
-        
+
         /**
          * checks to see if the lhs != rhs
          * @param   lhs the left hand side in question
@@ -173,46 +3788,40 @@ class Graph {
         friend bool operator != (const adj_iter& lhs, const adj_iter& rhs) {
             return !(lhs == rhs);
         }
-        
+
         /**
-         * creates a new adjcent vertex iterator
-         * @param   *owner the graph from which this iterator represents
-         * @param   ed the index of this iterator
-         * @param   vert the vertex of which to look at
+         * creates a new adjacent vertex iterator
+         * @param   p the position in the target array
          */
-        adj_iter(const Graph *owner_, std::size_t ed, int vert) :
-            vertex(vert),
-            index(ed),
-            owner(owner_)
-        {
-            assert(ed >= 0);
-        }
-        
+        explicit adj_iter(const std::size_t *p) :
+            pos(p)
+        {}
+
         /**
          * dereference this iterator
          * @returns the value at which this iterator is pointing
          */
-        int operator * () const {
-            return owner->_g[vertex][index].target;
+        std::size_t operator * () const {
+            return *pos;
         }
-        
+
         /**
          * (pre)increment this iterator
          * @returns this with its new value
          */
         adj_iter& operator ++ () {
-            ++index;
+            ++pos;
             return *this;
         }
     };
-    
+
     public:
         // --------
         // typedefs
         // --------
 
         typedef std::size_t     vertex_descriptor;
-        typedef std::size_t     edge_descriptor; //should make this struct edge, then could get rid of edge list
+        typedef std::size_t     edge_descriptor;
 
         typedef vert_iter       vertex_iterator;
         typedef edge_iter       edge_iterator;
@@ -220,13 +3829,6 @@ class Graph {
 
         typedef std::size_t     vertices_size_type;
         typedef std::size_t     edges_size_type;
-    
-        struct edge {
-            std::size_t         edge_no;
-            vertex_descriptor   source;
-            vertex_descriptor   target;
-        };
-
 
     public:
         // --------
@@ -234,35 +3836,38 @@ class Graph {
         // --------
 
         /**
-         * Adds edge (vdS,vdT) to the graph and returns the edge descriptor for the new edge
+         * Adds edge (vdS,vdT) to the graph and returns the edge descriptor for the new edge.
+         * The packed arrays have to be shifted to keep vdS's row sorted, so this is
+         * O(V + E); build a Graph and freeze it instead when loading many edges.
          * @param vdS   the vertex descriptor of the source
          * @param vdT   the vertex descriptor of the target
          * @param g     the graph to add the edge to
          * @returns     a pair with the edge descriptor and a boolean indicating whether or
          *              not an edge was added
          */
-        friend std::pair<edge_descriptor, bool> add_edge (vertex_descriptor vdS, vertex_descriptor vdT, Graph& g) {
-            assert(vdS >= 0);
-            assert(vdT >= 0);
-            
-            bool found = false;
-            edge_descriptor ret = 0;
-            
-            for(std::vector<edge>::iterator it = g._g[vdS].begin(); it != g._g[vdS].end(); ++it) {
-                if((*it).target == vdT) {
-                    found = true;
-                    break;
-                }
-            }
+        friend std::pair<edge_descriptor, bool> add_edge (vertex_descriptor vdS, vertex_descriptor vdT, CompactGraph& g) {
+            assert(vdS < num_vertices(g));
+            assert(vdT < num_vertices(g));
 
-            if(!found) {
-                ret = g.edge_label++;
-                struct edge new_edge = {ret, vdS, vdT};
-                g._g[vdS].push_back(new_edge);
-                g.edge_list.push_back(new_edge);
-            }
-            
-            return std::make_pair(ret, !found);
+            std::pair<edge_descriptor, bool> found = edge(vdS, vdT, g);
+            if(found.second)
+                return std::make_pair(found.first, false);
+
+            g.detach();
+
+            const std::size_t     slot = std::lower_bound(g._targets.begin() + g._offsets[vdS], g._targets.begin() + g._offsets[vdS + 1], vdT) - g._targets.begin();
+            const edge_descriptor ed   = g._slots.size();
+
+            g._targets.insert(g._targets.begin() + slot, vdT);
+            g._edge_ids.insert(g._edge_ids.begin() + slot, ed);
+            for(std::size_t v = vdS + 1; v < g._offsets.size(); ++v)
+                ++g._offsets[v];
+
+            g._slots.push_back(slot);
+            for(std::size_t i = slot + 1; i < g._edge_ids.size(); ++i)
+                g._slots[g._edge_ids[i]] = i;
+
+            return std::make_pair(ed, true);
         }
 
         // ----------
@@ -274,9 +3879,10 @@ class Graph {
          * @param g         the graph to add a vertex to
          * @returns         the vertex_descriptor of the added vertex
          */
-        friend vertex_descriptor add_vertex (Graph& g) {
-            g._g.push_back( std::vector<edge>() );
-            return g.vertex_label++;
+        friend vertex_descriptor add_vertex (CompactGraph& g) {
+            g.detach();
+            g._offsets.push_back(g._offsets.back());
+            return g._offsets.size() - 2;
         }
 
         // -----------------
@@ -284,16 +3890,16 @@ class Graph {
         // -----------------
 
         /**
-         * Returns an iterator-range providing access to the vertices adjacent to vertex 
-         * u in graph g. For example, if u -> v is an edge in the graph, then v will be 
-         * in this iterator-range.
+         * Returns an iterator-range providing access to the vertices adjacent to vertex
+         * u in graph g.
          * @param   vd      the vertex to look at
          * @param   g       the graph to look in
          * @returns         a pair of iterators, begin and end
          */
-        friend std::pair<adjacency_iterator, adjacency_iterator> adjacent_vertices (vertex_descriptor vd, const Graph& g) {
-            assert(vd >= 0);
-            return std::make_pair(adj_iter(&g, 0, vd), adj_iter(&g, g._g[vd].size(), vd));
+        friend std::pair<adjacency_iterator, adjacency_iterator> adjacent_vertices (vertex_descriptor vd, const CompactGraph& g) {
+            assert(vd < num_vertices(g));
+            const std::size_t *offsets = g.offsets();
+            return std::make_pair(adj_iter(g.targets() + offsets[vd]), adj_iter(g.targets() + offsets[vd + 1]));
         }
 
         // ----
@@ -302,29 +3908,23 @@ class Graph {
 
         /**
          * If an edge from vertex u to vertex v exists, return a pair containing one such
-         * edge and true. If there are no edges between u and v, return a pair with an 
-         * arbitrary edge descriptor and false.
+         * edge and true. If there are no edges between u and v, return a pair with an
+         * arbitrary edge descriptor and false. O(log d), by binary search of the sorted row.
          * @param   vdS     vertex descriptor of the source
          * @param   vdT     vertex descriptor of the target
          * @param   g       the graph to look in
-         * @returns         a pair including the edge descriptor of the found edge and a 
+         * @returns         a pair including the edge descriptor of the found edge and a
          *                  boolean indicating whether or not an edge was found
          */
-        friend std::pair<edge_descriptor, bool> edge (vertex_descriptor vdS, vertex_descriptor vdT, const Graph& g) {
-            assert(vdS >= 0);
-            assert(vdT >= 0);
-            edge_descriptor ed = 0;
-            bool            b  = false;
-            
-            for(std::vector<edge>::const_iterator it = g._g[vdS].begin(); it != g._g[vdS].end(); ++it) {
-                if((*it).target == vdT) {
-                    ed = (*it).edge_no;
-                    b = true;
-                    break;
-                }
-            }
-            
-            return std::make_pair(ed, b);
+        friend std::pair<edge_descriptor, bool> edge (vertex_descriptor vdS, vertex_descriptor vdT, const CompactGraph& g) {
+            assert(vdS < num_vertices(g));
+            const std::size_t *offsets = g.offsets();
+            const std::size_t *targets = g.targets();
+            const std::size_t *end     = targets + offsets[vdS + 1];
+            const std::size_t *found   = std::lower_bound(targets + offsets[vdS], end, vdT);
+            if(found == end || *found != vdT)
+                return std::make_pair(edge_descriptor(0), false);
+            return std::make_pair(g.edge_ids()[found - targets], true);
         }
 
         // -----
@@ -336,8 +3936,8 @@ class Graph {
          * @param   g   the graph to look in
          * @returns     a pair of iterators, begin and end encompassing all edges
          */
-        friend std::pair<edge_iterator, edge_iterator> edges (const Graph& g) {
-            return std::make_pair(edge_iter(&g, 0), edge_iter(&g, g.edge_label));
+        friend std::pair<edge_iterator, edge_iterator> edges (const CompactGraph& g) {
+            return std::make_pair(edge_iter(0), edge_iter(num_edges(g)));
         }
 
         // ---------
@@ -349,8 +3949,8 @@ class Graph {
          * @param   g   the graph in question
          * @returns     the number of edges in graph g
          */
-        friend edges_size_type num_edges (const Graph& g) {
-            return g.edge_label;
+        friend edges_size_type num_edges (const CompactGraph& g) {
+            return g._file ? g._file->edges : g._slots.size();
         }
 
         // ------------
@@ -362,8 +3962,8 @@ class Graph {
          * @param   g   the graph in question
          * @returns     the number of vertices in graph g
          */
-        friend vertices_size_type num_vertices (const Graph& g) {
-            return g.vertex_label;
+        friend vertices_size_type num_vertices (const CompactGraph& g) {
+            return g._file ? g._file->vertices : g._offsets.size() - 1;
         }
 
         // ------
@@ -372,13 +3972,15 @@ class Graph {
 
         /**
          * Returns the source vertex of edge ed.
+         * The source is not stored; it is recovered from the offsets in O(log V).
          * @param   ed  the edge descriptor of the edge in question
          * @param   g   the graph to look in
          * @returns     the vertex descriptor of the source of the edge
          */
-        friend vertex_descriptor source (edge_descriptor ed, const Graph& g) {
-            assert(ed >= 0);
-            return g.edge_list[ed].source;
+        friend vertex_descriptor source (edge_descriptor ed, const CompactGraph& g) {
+            assert(ed < num_edges(g));
+            const std::size_t *offsets = g.offsets();
+            return std::upper_bound(offsets, offsets + num_vertices(g) + 1, g.slots()[ed]) - offsets - 1;
         }
 
         // ------
@@ -391,9 +3993,32 @@ class Graph {
          * @param   g   the graph to look in
          * @returns     the vertex descriptor of the target of the edge
          */
-        friend vertex_descriptor target (edge_descriptor ed, const Graph& g) {
-            assert(ed >= 0);
-            return g.edge_list[ed].target;
+        friend vertex_descriptor target (edge_descriptor ed, const CompactGraph& g) {
+            assert(ed < num_edges(g));
+            return g.targets()[g.slots()[ed]];
+        }
+
+        // ----------
+        // edge_index
+        // ----------
+
+        /**
+         * Returns the edge number of edge ed, a dense index for edge property maps.
+         * Edge descriptors are already dense, so this is ed itself.
+         * @param   ed  the edge descriptor of the edge in question
+         * @param   g   the graph to look in
+         * @returns     ed
+         */
+        friend edges_size_type edge_index (edge_descriptor ed, const CompactGraph&) {
+            return ed;
+        }
+
+        /**
+         * @param   g   the graph in question
+         * @returns     the size of an array indexed by edge_index
+         */
+        friend edges_size_type edge_index_bound (const CompactGraph& g) {
+            return num_edges(g);
         }
 
         // ------
@@ -406,8 +4031,9 @@ class Graph {
          * @param   g   the graph to look in
          * @returns     the vertex descriptor of the nth vertex
          */
-        friend vertex_descriptor vertex (vertices_size_type n, const Graph& g) {
-            assert(n >= 0);
+        friend vertex_descriptor vertex (vertices_size_type n, const CompactGraph& g) {
+            assert(n < num_vertices(g));
+            (void) g;
             return n;
         }
 
@@ -420,18 +4046,75 @@ class Graph {
          * @param   g   the graph to look at
          * @returns     a pair of iterators which encompass all vertices in g
          */
-        friend std::pair<vertex_iterator, vertex_iterator> vertices (const Graph& g) {
-            return std::make_pair(vert_iter(&g,0), vert_iter(&g, g.vertex_label));
+        friend std::pair<vertex_iterator, vertex_iterator> vertices (const CompactGraph& g) {
+            return std::make_pair(vert_iter(0), vert_iter(num_vertices(g)));
         }
 
+        // ------
+        // freeze
+        // ------
+
+        template <typename D, bool L>
+        friend CompactGraph freeze (const basic_graph<D, L>& g);
+
+        // ----------
+        // save_graph
+        // ----------
+
+        friend void save_graph (const CompactGraph& g, const std::string& path);
+
+        // ---------
+        // map_graph
+        // ---------
+
+        friend CompactGraph map_graph (const std::string& path);
+
     private:
         // ----
         // data
         // ----
-        std::vector< std::vector<Graph::edge> > _g;     //the 2d structure
-        vertex_descriptor vertex_label;                 //counter for vertex labels
-        edge_descriptor edge_label;                     //counter for edge labels
-        std::vector<edge> edge_list;                     //could get rid of this...
+        std::vector<std::size_t>       _offsets;   //out-edges of v live in [_offsets[v], _offsets[v + 1])
+        std::vector<vertex_descriptor> _targets;   //packed targets, one per slot
+        std::vector<edge_descriptor>   _edge_ids;  //edge descriptor of each slot
+        std::vector<std::size_t>       _slots;     //slot of each edge descriptor
+        std::shared_ptr<const graph_detail::mapped_graph> _file; //set when the arrays live in a mapped file
+
+        // ---------
+        // accessors
+        // ---------
+
+        /**
+         * the packed arrays, from the mapped file if there is one and from the
+         * owned vectors otherwise
+         */
+        const std::size_t* offsets () const {
+            return _file ? _file->offsets : _offsets.data();}
+
+        const vertex_descriptor* targets () const {
+            return _file ? _file->targets : _targets.data();}
+
+        const edge_descriptor* edge_ids () const {
+            return _file ? _file->edge_ids : _edge_ids.data();}
+
+        const std::size_t* slots () const {
+            return _file ? _file->slots : _slots.data();}
+
+        // ------
+        // detach
+        // ------
+
+        /**
+         * copies a mapped graph into owned vectors so that it can be modified
+         */
+        void detach () {
+            if(!_file)
+                return;
+            _offsets.assign(offsets(), offsets() + _file->vertices + 1);
+            _targets.assign(targets(), targets() + _file->edges);
+            _edge_ids.assign(edge_ids(), edge_ids() + _file->edges);
+            _slots.assign(slots(), slots() + _file->edges);
+            _file.reset();
+        }
 
         // -----
         // valid
@@ -442,7 +4125,12 @@ class Graph {
          * @returns     true if valid
          */
         bool valid () const {
-            return vertex_label >= 0 && edge_label >= 0;
+            if(_file)
+                return offsets()[_file->vertices] == _file->edges;
+            return !_offsets.empty() &&
+                   _offsets.back() == _targets.size() &&
+                   _targets.size() == _edge_ids.size() &&
+                   _edge_ids.size() == _slots.size();
         }
 
     public:
@@ -451,19 +4139,1106 @@ class Graph {
         // ------------
 
         /**
-         * A simple graph implementation based on boost's adjacency_list.
-         * Constructs a new graph with no edges or vertices
+         * Constructs a new compact graph with no edges or vertices
          */
-        Graph () {
-            vertex_label = 0;
-            edge_label = 0;
+        CompactGraph () :
+            _offsets(1, 0)
+        {
             assert(valid());
         }
 
         // Default copy, destructor, and copy assignment
-        // Graph  (const Graph<T>&);
-        // ~Graph ();
-        // Graph& operator = (const Graph&);
+        // CompactGraph  (const CompactGraph&);
+        // ~CompactGraph ();
+        // CompactGraph& operator = (const CompactGraph&);
+    };
+
+// ------
+// freeze
+// ------
+
+/**
+ * Packs the adjacency lists of g into a CompactGraph in one pass, sorting each
+ * vertex's out-edges by target. Vertex and edge descriptors are preserved,
+ * except that a graph with removed vertices or edges is frozen as compact would leave it.
+ * @param   g   the graph to freeze
+ * @returns     a compressed sparse row copy of g
+ */
+template <typename Descriptor, bool EdgeList>
+inline CompactGraph freeze (const basic_graph<Descriptor, EdgeList>& g) {
+    if(g._dead_vertices != 0 || g._dead_edges != 0) {
+        basic_graph<Descriptor, EdgeList> compacted(g);
+        compact(compacted);
+        return freeze(compacted);
+    }
+
+    CompactGraph c;
+    c._offsets.reserve(g.vertex_label + 1);
+    c._targets.reserve(g.edge_label);
+    c._edge_ids.reserve(g.edge_label);
+    c._slots.resize(g.edge_label);
+
+    typedef typename basic_graph<Descriptor, EdgeList>::out_edge out_edge;
+    std::vector<out_edge> row;
+    for(std::size_t v = 0; v < g.vertex_label; ++v) {
+        row.assign(g._g[v].begin(), g._g[v].end());
+        std::sort(row.begin(), row.end(), [] (const out_edge& x, const out_edge& y) {
+            return x.target < y.target;});
+        for(typename std::vector<out_edge>::const_iterator it = row.begin(); it != row.end(); ++it) {
+            c._slots[(*it).edge_no] = c._targets.size();
+            c._targets.push_back((*it).target);
+            c._edge_ids.push_back((*it).edge_no);
+        }
+        c._offsets.push_back(c._targets.size());
+    }
+
+    assert(c.valid());
+    return c;
+}
+
+// ----------
+// save_graph
+// ----------
+
+/**
+ * Writes g to path in the binary graph format that map_graph reads.
+ * @param   g       the graph to write
+ * @param   path    the file to create or overwrite
+ * @throws  std::runtime_error if the file cannot be written
+ */
+inline void save_graph (const CompactGraph& g, const std::string& path) {
+    graph_detail::graph_header h;
+    std::memcpy(h.magic, "CSRGRAPH", sizeof(h.magic));
+    h.version    = graph_detail::graph_version;
+    h.word_size  = sizeof(std::size_t);
+    h.byte_order = 0x0102;
+    h.vertices   = num_vertices(g);
+    h.edges      = num_edges(g);
+
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    out.write(reinterpret_cast<const char*>(g.offsets()),  (h.vertices + 1) * sizeof(std::size_t));
+    out.write(reinterpret_cast<const char*>(g.targets()),  h.edges * sizeof(std::size_t));
+    out.write(reinterpret_cast<const char*>(g.edge_ids()), h.edges * sizeof(std::size_t));
+    out.write(reinterpret_cast<const char*>(g.slots()),    h.edges * sizeof(std::size_t));
+    out.close();
+    if(!out)
+        throw std::runtime_error("save_graph: cannot write " + path);
+}
+
+/**
+ * Freezes g and writes it to path in the binary graph format.
+ * @param   g       the graph to write
+ * @param   path    the file to create or overwrite
+ * @throws  std::runtime_error if the file cannot be written
+ */
+template <typename Descriptor, bool EdgeList>
+inline void save_graph (const basic_graph<Descriptor, EdgeList>& g, const std::string& path) {
+    save_graph(freeze(g), path);
+}
+
+// ---------
+// map_graph
+// ---------
+
+/**
+ * Maps a file written by save_graph into memory and returns a CompactGraph
+ * that reads straight from the mapped pages, without parsing or copying.
+ * The arrays are checked in one sequential pass, so that a damaged file
+ * cannot send later lookups out of bounds or break edge()'s binary search.
+ * The pages are shared with every other process mapping the same file.
+ * Modifying the returned graph first copies it into memory.
+ * @param   path    the file to map
+ * @returns         a read-only view of the graph in the file
+ * @throws  std::runtime_error if the file cannot be mapped, is not a graph
+ *          file of this version, word size and byte order, or its offsets,
+ *          targets, edge ids or slots are out of range, or a row is not
+ *          strictly ascending
+ */
+inline CompactGraph map_graph (const std::string& path) {
+    std::shared_ptr<graph_detail::mapped_graph> file(new graph_detail::mapped_graph(path));
+    if(file->length < sizeof(graph_detail::graph_header))
+        throw std::runtime_error("map_graph: not a compatible graph file: " + path);
+
+    const graph_detail::graph_header& h = *static_cast<const graph_detail::graph_header*>(file->base);
+    if(std::memcmp(h.magic, "CSRGRAPH", sizeof(h.magic)) != 0 ||
+       h.version    != graph_detail::graph_version ||
+       h.word_size  != sizeof(std::size_t) ||
+       h.byte_order != 0x0102)
+        throw std::runtime_error("map_graph: not a compatible graph file: " + path);
+    const std::size_t words = file->length / sizeof(std::size_t);
+    if(h.vertices >= words || h.edges >= words ||
+       file->length != sizeof(h) + (h.vertices + 1 + 3 * h.edges) * sizeof(std::size_t))
+        throw std::runtime_error("map_graph: truncated graph file: " + path);
+
+    file->vertices = h.vertices;
+    file->edges    = h.edges;
+    file->offsets  = reinterpret_cast<const std::size_t*>(file->data() + sizeof(h));
+    file->targets  = file->offsets  + h.vertices + 1;
+    file->edge_ids = file->targets  + h.edges;
+    file->slots    = file->edge_ids + h.edges;
+
+    const std::size_t n  = h.vertices;
+    const std::size_t m  = h.edges;
+    bool              ok = file->offsets[0] == 0 && file->offsets[n] == m;
+    for(std::size_t v = 0; ok && v < n; ++v)
+        ok = file->offsets[v] <= file->offsets[v + 1];
+    for(std::size_t i = 0; ok && i < m; ++i)
+        ok = file->targets[i] < n && file->edge_ids[i] < m && file->slots[i] < m;
+    for(std::size_t v = 0; ok && v < n; ++v) {
+        for(std::size_t i = file->offsets[v] + 1; ok && i < file->offsets[v + 1]; ++i)
+            ok = file->targets[i - 1] < file->targets[i];
+    }
+    if(!ok)
+        throw std::runtime_error("map_graph: corrupt graph file: " + path);
+
+    CompactGraph g;
+    g._offsets.clear();
+    g._file = file;
+    assert(g.valid());
+    return g;
+}
+
+// ---------------
+// edge_list_stats
+// ---------------
+
+/**
+ * What read_edge_list loaded and how fast it went.
+ */
+struct edge_list_stats {
+    std::size_t                bytes;        //size of the input file
+    std::size_t                lines;        //edge lines parsed
+    std::size_t                edges;        //edges added to the graph
+    double                     seconds;      //wall time of the whole load
+    double                     parse_seconds;//wall time of splitting and parsing the mapped text
+    std::size_t                first_vertex; //descriptor of the first vertex added
+    std::vector<std::uint64_t> ids;          //ids[i] is the file's id of vertex first_vertex + i
+
+    /**
+     * @returns the parse throughput of the load, leaving out mapping the file
+     *          and building the graph
+     */
+    double bytes_per_second () const {
+        return parse_seconds > 0 ? bytes / parse_seconds : 0;
+    }
+};
+
+// --------------
+// read_edge_list
+// --------------
+
+/**
+ * Loads a text edge list into g: either a SNAP file, with one "source target"
+ * pair per line and # comments, or a Matrix Market coordinate file, whose
+ * symmetric matrices get edges in both directions.
+ * The file is mapped and split at line boundaries into one chunk per thread,
+ * and the chunks are parsed in parallel. Every distinct id in the file gets a new
+ * vertex, numbered in order of first appearance, and the edges are added with
+ * add_edges.
+ * @param   path    the file to read
+ * @param   g       the graph to add the vertices and edges to
+ * @returns         the id mapping, counts and parse throughput
+ * @throws  std::runtime_error if the file cannot be read or has a malformed line
+ *          or an id over 2^64 - 1
+ */
+template <typename Descriptor, bool EdgeList>
+inline edge_list_stats read_edge_list (const std::string& path, basic_graph<Descriptor, EdgeList>& g) {
+    typedef typename basic_graph<Descriptor, EdgeList>::vertex_descriptor vertex_descriptor;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    graph_detail::mapped_file file(path, "read_edge_list");
+    const char *text = file.data();
+    const std::size_t n = file.length;
+    if(n != 0)
+        madvise(file.base, n, MADV_SEQUENTIAL);
+    const std::chrono::steady_clock::time_point parse = std::chrono::steady_clock::now();
+
+    // a Matrix Market banner is followed by comments and a "rows columns entries" line
+    std::size_t begin = 0;
+    bool symmetric = false;
+    static const char banner[] = "%%MatrixMarket";
+    if(n >= sizeof(banner) - 1 && std::memcmp(text, banner, sizeof(banner) - 1) == 0) {
+        const char *eol = static_cast<const char*>(std::memchr(text, '\n', n));
+        symmetric = std::string(text, eol ? eol - text : n).find("symmetric") != std::string::npos;
+        bool size_line = false;
+        while(begin < n && !size_line) {
+            size_line = text[begin] != '%' && text[begin] != '\n' && text[begin] != '\r';
+            eol = static_cast<const char*>(std::memchr(text + begin, '\n', n - begin));
+            begin = eol ? eol - text + 1 : n;
+        }
+    }
+
+    const std::size_t t = graph_detail::thread_count(n - begin, 1 << 20);
+    std::vector<std::size_t> cuts(1, begin);
+    for(std::size_t i = 1; i < t; ++i) {
+        std::size_t c = std::max(begin + (n - begin) * i / t, cuts.back());
+        while(c < n && text[c - 1] != '\n')
+            ++c;
+        cuts.push_back(c);
+    }
+    cuts.push_back(n);
+
+    std::vector< std::vector<std::uint64_t> > ids(t);
+    std::vector<char> ok(t);
+    graph_detail::parallel_for(t, [&] (std::size_t b, std::size_t e) {
+        for(std::size_t i = b; i < e; ++i) {
+            ids[i].reserve((cuts[i + 1] - cuts[i]) / 8);
+            ok[i] = graph_detail::parse_edge_lines(text + cuts[i], text + cuts[i + 1], ids[i]);
+        }
+    }, 1);
+    if(std::find(ok.begin(), ok.end(), 0) != ok.end())
+        throw std::runtime_error("read_edge_list: malformed line or id out of range in " + path);
+
+    edge_list_stats stats;
+    stats.bytes         = n;
+    stats.lines         = 0;
+    stats.parse_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - parse).count();
+    stats.first_vertex  = num_vertices(g);
+    for(std::size_t i = 0; i < t; ++i)
+        stats.lines += ids[i].size() / 2;
+
+    std::unordered_map<std::uint64_t, vertex_descriptor> dense;
+    std::vector< std::pair<vertex_descriptor, vertex_descriptor> > pairs;
+    pairs.reserve(symmetric ? 2 * stats.lines : stats.lines);
+    for(std::size_t i = 0; i < t; ++i) {
+        for(std::size_t j = 0; j < ids[i].size(); j += 2) {
+            vertex_descriptor vd[2];
+            for(int k = 0; k < 2; ++k) {
+                std::pair<typename std::unordered_map<std::uint64_t, vertex_descriptor>::iterator, bool> r =
+                    dense.insert(std::make_pair(ids[i][j + k], vertex_descriptor(0)));
+                if(r.second) {
+                    r.first->second = add_vertex(g);
+                    if(stats.ids.empty())
+                        stats.first_vertex = r.first->second;
+                    stats.ids.push_back(ids[i][j + k]);
+                }
+                vd[k] = r.first->second;
+            }
+            pairs.push_back(std::make_pair(vd[0], vd[1]));
+            if(symmetric && vd[0] != vd[1])
+                pairs.push_back(std::make_pair(vd[1], vd[0]));
+        }
+        std::vector<std::uint64_t>().swap(ids[i]);
+    }
+
+    reserve_edges(num_edges(g) + pairs.size(), g);
+    stats.edges   = add_edges(pairs.begin(), pairs.end(), g);
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+// -----------------
+// edge_property_map
+// -----------------
+
+/**
+ * A value of type T for every edge of a graph, such as its weight, stored in one
+ * contiguous array indexed by edge_index. Each property gets its own map, so a
+ * sweep over one property touches nothing else.
+ * Indexing a non-const map with an edge added after it was made grows the map,
+ * filling new slots with its default value. Compacting the graph renumbers its
+ * edges and invalidates the map.
+ */
+template <typename G, typename T>
+class edge_property_map {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef typename G::edge_descriptor key_type;
+        typedef T                           value_type;
+
+    private:
+        // ----
+        // data
+        // ----
+        const G        *_g;         //the graph whose edges are the keys
+        std::vector<T>  _values;    //the values, by edge_index
+        T               _default;   //the value of edges not yet assigned
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * Constructs a map that gives every edge of g the value value.
+         * @param g         the graph whose edges are the keys; must outlive the map
+         * @param value     the initial value of every edge
+         */
+        explicit edge_property_map (const G& g, const T& value = T()) :
+            _g(&g),
+            _values(edge_index_bound(g), value),
+            _default(value)
+        {}
+
+        // -----------
+        // operator []
+        // -----------
+
+        /**
+         * @param ed    an edge descriptor of the graph
+         * @returns     a reference to the value of ed
+         */
+        T& operator [] (key_type ed) {
+            const std::size_t i = edge_index(ed, *_g);
+            if(i >= _values.size())
+                _values.resize(edge_index_bound(*_g), _default);
+            return _values[i];
+        }
+
+        /**
+         * @param ed    an edge descriptor of the graph
+         * @returns     the value of ed
+         */
+        const T& operator [] (key_type ed) const {
+            const std::size_t i = edge_index(ed, *_g);
+            return i < _values.size() ? _values[i] : _default;
+        }
+
+        // ----
+        // data
+        // ----
+
+        /**
+         * @returns the values, indexed by edge_index
+         */
+        const std::vector<T>& data () const {
+            return _values;
+        }
+
+        // -------
+        // get/put
+        // -------
+
+        /**
+         * boost-style read access
+         * @param pm    the map
+         * @param ed    an edge descriptor of the graph
+         * @returns     the value of ed
+         */
+        friend const T& get (const edge_property_map& pm, key_type ed) {
+            return pm[ed];
+        }
+
+        /**
+         * boost-style write access
+         * @param pm    the map
+         * @param ed    an edge descriptor of the graph
+         * @param value the new value of ed
+         */
+        friend void put (edge_property_map& pm, key_type ed, const T& value) {
+            pm[ed] = value;
+        }
+};
+
+// --------------------
+// breadth_first_search
+// --------------------
+
+/**
+ * Direction-optimizing breadth first search from s (Beamer, Asanovic and Patterson).
+ * Each level either pushes from the frontier along out-edges (top-down) or, once the
+ * frontier's edges outnumber a fraction of the unvisited vertices' edges, has every
+ * unvisited vertex pull from a frontier bitmap along its in-edges (bottom-up).
+ * Both steps are split across threads. Distances are exact; when a vertex has several
+ * parents on the previous level, which one is recorded depends on thread timing.
+ * @param   g           the graph to search
+ * @param   s           the source vertex
+ * @param   parent      set to the BFS tree parent of each vertex; s and unreached
+ *                      vertices are their own parent
+ * @param   distance    set to the number of edges on a shortest path from s, or to
+ *                      std::numeric_limits<std::size_t>::max() if there is none
+ */
+template <typename G>
+void breadth_first_search (const G& g, typename G::vertex_descriptor s,
+                           std::vector<typename G::vertex_descriptor>& parent,
+                           std::vector<std::size_t>& distance) {
+    static const std::size_t alpha     = 14;
+    static const std::size_t beta      = 24;
+    static const std::size_t unreached = std::numeric_limits<std::size_t>::max();
+
+    const graph_detail::csr out = graph_detail::out_csr(g);
+    const std::size_t       n   = out.size();
+    assert(s < n);
+    graph_detail::csr in;
+
+    parent.resize(n);
+    std::vector< std::atomic<std::size_t> > level(n);
+    for(std::size_t v = 0; v < n; ++v) {
+        parent[v] = v;
+        level[v].store(unreached, std::memory_order_relaxed);
+    }
+    level[s].store(0, std::memory_order_relaxed);
+
+    std::vector<std::size_t>   frontier(1, s);
+    std::vector<std::uint64_t> front;
+    std::vector<std::uint64_t> next;
+    std::mutex                 merge;
+    std::size_t unexplored = out.targets.size() - out.degree(s);
+    bool        bottom_up  = false;
+
+    for(std::size_t depth = 1; !frontier.empty(); ++depth) {
+        std::size_t frontier_edges = 0;
+        for(std::size_t i = 0; i < frontier.size(); ++i)
+            frontier_edges += out.degree(frontier[i]);
+        if(!bottom_up && frontier_edges > unexplored / alpha)
+            bottom_up = true;
+        else if(bottom_up && frontier.size() < n / beta)
+            bottom_up = false;
+
+        std::vector<std::size_t> discovered;
+        if(!bottom_up) {
+            graph_detail::parallel_for(frontier.size(), [&] (std::size_t b, std::size_t e) {
+                std::vector<std::size_t> local;
+                for(std::size_t i = b; i < e; ++i) {
+                    const std::size_t u = frontier[i];
+                    for(std::size_t j = out.offsets[u]; j < out.offsets[u + 1]; ++j) {
+                        const std::size_t v = out.targets[j];
+                        std::size_t expected = unreached;
+                        if(level[v].load(std::memory_order_relaxed) == unreached &&
+                           level[v].compare_exchange_strong(expected, depth, std::memory_order_relaxed)) {
+                            parent[v] = u;
+                            local.push_back(v);
+                        }
+                    }
+                }
+                std::lock_guard<std::mutex> lock(merge);
+                discovered.insert(discovered.end(), local.begin(), local.end());
+            }, 256);
+        }
+        else {
+            if(in.offsets.empty())
+                in = graph_detail::transpose(out);
+            const std::size_t words = (n + 63) / 64;
+            front.assign(words, 0);
+            next.assign(words, 0);
+            for(std::size_t i = 0; i < frontier.size(); ++i)
+                front[frontier[i] / 64] |= std::uint64_t(1) << (frontier[i] % 64);
+
+            // each thread owns whole words of next, so the bitmap needs no atomics
+            graph_detail::parallel_for(words, [&] (std::size_t b, std::size_t e) {
+                for(std::size_t v = 64 * b; v < std::min(64 * e, n); ++v) {
+                    if(level[v].load(std::memory_order_relaxed) != unreached)
+                        continue;
+                    for(std::size_t j = in.offsets[v]; j < in.offsets[v + 1]; ++j) {
+                        const std::size_t u = in.targets[j];
+                        if(front[u / 64] & (std::uint64_t(1) << (u % 64))) {
+                            level[v].store(depth, std::memory_order_relaxed);
+                            parent[v] = u;
+                            next[v / 64] |= std::uint64_t(1) << (v % 64);
+                            break;
+                        }
+                    }
+                }
+            }, 64);
+            for(std::size_t w = 0; w < words; ++w) {
+                for(std::uint64_t bits = next[w]; bits != 0; bits &= bits - 1)
+                    discovered.push_back(64 * w + __builtin_ctzll(bits));
+            }
+        }
+
+        for(std::size_t i = 0; i < discovered.size(); ++i)
+            unexplored -= out.degree(discovered[i]);
+        frontier.swap(discovered);
+    }
+
+    distance.resize(n);
+    for(std::size_t v = 0; v < n; ++v)
+        distance[v] = level[v].load(std::memory_order_relaxed);
+}
+
+// ---------
+// not_a_dag
+// ---------
+
+/**
+ * Thrown by the topological sorts when the graph has a cycle.
+ */
+struct not_a_dag : std::invalid_argument {
+    not_a_dag () :
+        std::invalid_argument("The graph must be a DAG.")
+    {}
+};
+
+// ----------------
+// topological_sort
+// ----------------
+
+/**
+ * Writes the vertices of g to out in reverse topological order, as boost's
+ * topological_sort does: for every edge (u,v), v is written before u.
+ * Uses Kahn's algorithm with an in-degree array and an explicit queue, so deep
+ * graphs cannot overflow the stack.
+ * @param   g   the graph to sort
+ * @param   out an output iterator of vertex descriptors
+ * @returns     out, past the last vertex written
+ * @throws  not_a_dag if g has a cycle, before anything is written
+ */
+template <typename G, typename OutputIterator>
+OutputIterator topological_sort (const G& g, OutputIterator out) {
+    std::vector<std::size_t> in = graph_detail::in_degrees(g);
+    std::vector<typename G::vertex_descriptor> order;
+    order.reserve(num_vertices(g));
+    std::pair<typename G::vertex_iterator, typename G::vertex_iterator> v = vertices(g);
+    for(; v.first != v.second; ++v.first) {
+        if(in[*v.first] == 0)
+            order.push_back(*v.first);
+    }
+    for(std::size_t i = 0; i < order.size(); ++i) {
+        std::pair<typename G::adjacency_iterator, typename G::adjacency_iterator> p = adjacent_vertices(order[i], g);
+        for(; p.first != p.second; ++p.first) {
+            if(--in[*p.first] == 0)
+                order.push_back(*p.first);
+        }
+    }
+    if(order.size() != num_vertices(g))
+        throw not_a_dag();
+    return std::copy(order.rbegin(), order.rend(), out);
+}
+
+// -------------------------
+// parallel_topological_sort
+// -------------------------
+
+/**
+ * Level-synchronous topological sort for wide DAGs: every vertex whose
+ * predecessors are all on earlier levels forms the next level, and each level's
+ * out-edges are relaxed in parallel. The output is the same reverse topological
+ * order as topological_sort, with the vertices of a level in ascending order.
+ * @param   g   the graph to sort
+ * @param   out an output iterator of vertex descriptors
+ * @returns     out, past the last vertex written
+ * @throws  not_a_dag if g has a cycle, before anything is written
+ */
+template <typename G, typename OutputIterator>
+OutputIterator parallel_topological_sort (const G& g, OutputIterator out) {
+    const std::vector<std::size_t> degrees = graph_detail::in_degrees(g);
+    std::vector< std::atomic<std::size_t> > in(degrees.size());
+    std::vector<typename G::vertex_descriptor> order;
+    order.reserve(num_vertices(g));
+    for(std::size_t v = 0; v < degrees.size(); ++v)
+        in[v].store(degrees[v], std::memory_order_relaxed);
+    std::pair<typename G::vertex_iterator, typename G::vertex_iterator> v = vertices(g);
+    for(; v.first != v.second; ++v.first) {
+        if(degrees[*v.first] == 0)
+            order.push_back(*v.first);
+    }
+
+    std::mutex merge;
+    for(std::size_t level = 0; level != order.size(); ) {
+        const std::size_t end = order.size();
+        std::vector<typename G::vertex_descriptor> next;
+        graph_detail::parallel_for(end - level, [&] (std::size_t b, std::size_t e) {
+            std::vector<typename G::vertex_descriptor> local;
+            for(std::size_t i = level + b; i < level + e; ++i) {
+                std::pair<typename G::adjacency_iterator, typename G::adjacency_iterator> p = adjacent_vertices(order[i], g);
+                for(; p.first != p.second; ++p.first) {
+                    if(in[*p.first].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                        local.push_back(*p.first);
+                }
+            }
+            std::lock_guard<std::mutex> lock(merge);
+            next.insert(next.end(), local.begin(), local.end());
+        }, 256);
+        std::sort(next.begin(), next.end());
+        order.insert(order.end(), next.begin(), next.end());
+        level = end;
+    }
+    if(order.size() != num_vertices(g))
+        throw not_a_dag();
+    return std::copy(order.rbegin(), order.rend(), out);
+}
+
+// ---------
+// has_cycle
+// ---------
+
+/**
+ * @param   g   the graph to check
+ * @returns     true if g has a directed cycle, self-loops included
+ */
+template <typename G>
+bool has_cycle (const G& g) {
+    std::vector<std::size_t> in = graph_detail::in_degrees(g);
+    std::vector<typename G::vertex_descriptor> ready;
+    std::pair<typename G::vertex_iterator, typename G::vertex_iterator> v = vertices(g);
+    for(; v.first != v.second; ++v.first) {
+        if(in[*v.first] == 0)
+            ready.push_back(*v.first);
+    }
+    std::size_t removed = 0;
+    while(!ready.empty()) {
+        const typename G::vertex_descriptor u = ready.back();
+        ready.pop_back();
+        ++removed;
+        std::pair<typename G::adjacency_iterator, typename G::adjacency_iterator> p = adjacent_vertices(u, g);
+        for(; p.first != p.second; ++p.first) {
+            if(--in[*p.first] == 0)
+                ready.push_back(*p.first);
+        }
+    }
+    return removed != num_vertices(g);
+}
+
+// -------------
+// negative_edge
+// -------------
+
+/**
+ * Thrown by the shortest path algorithms when an edge has a negative weight.
+ */
+struct negative_edge : std::invalid_argument {
+    negative_edge () :
+        std::invalid_argument("The graph may not contain an edge with negative weight.")
+    {}
+};
+
+// -----------------------
+// dijkstra_shortest_paths
+// -----------------------
+
+/**
+ * Dijkstra's single-source shortest paths from s. The weights are copied once
+ * into a weighted adjacency array, and the frontier is an indexed 4-ary heap
+ * with decrease-key, so the inner loop does no hashing and no allocation.
+ * @param   g           the graph to search
+ * @param   s           the source vertex
+ * @param   weight      the weight of every edge, e.g. an edge_property_map;
+ *                      WeightMap::value_type is the distance type
+ * @param   predecessor set to the previous vertex on a shortest path from s;
+ *                      s and unreached vertices are their own predecessor
+ * @param   distance    set to the length of a shortest path from s, or to
+ *                      std::numeric_limits<value_type>::max() if there is none
+ * @throws  negative_edge if some edge has a negative weight
+ */
+template <typename G, typename WeightMap>
+void dijkstra_shortest_paths (const G& g, typename G::vertex_descriptor s, const WeightMap& weight,
+                              std::vector<typename G::vertex_descriptor>& predecessor,
+                              std::vector<typename WeightMap::value_type>& distance) {
+    typedef typename WeightMap::value_type W;
+    const W infinity = std::numeric_limits<W>::max();
+
+    const graph_detail::weighted_csr<W> out = graph_detail::out_weighted_csr(g, weight);
+    const std::size_t                   n   = out.size();
+    assert(s < n);
+    for(std::size_t i = 0; i < out.weights.size(); ++i) {
+        if(out.weights[i] < W())
+            throw negative_edge();
+    }
+
+    predecessor.resize(n);
+    distance.assign(n, infinity);
+    for(std::size_t v = 0; v < n; ++v)
+        predecessor[v] = v;
+    distance[s] = W();
+
+    graph_detail::dary_heap<W> heap(distance);
+    heap.push_or_decrease(s);
+    while(!heap.empty()) {
+        const std::size_t u = heap.pop();
+        for(std::size_t i = out.offsets[u]; i < out.offsets[u + 1]; ++i) {
+            const std::size_t v = out.targets[i];
+            const W           d = distance[u] + out.weights[i];
+            if(d < distance[v]) {
+                distance[v]    = d;
+                predecessor[v] = u;
+                heap.push_or_decrease(v);
+            }
+        }
+    }
+}
+
+// -----------------------------
+// delta_stepping_shortest_paths
+// -----------------------------
+
+/**
+ * Parallel single-source shortest paths by delta-stepping (Meyer and Sanders).
+ * Vertices are kept in buckets of width delta by tentative distance. The lowest
+ * bucket is emptied by relaxing the light edges (weight at most delta) of all its
+ * vertices in parallel, over and over, since that can refill it; then the heavy
+ * edges of every vertex it settled are relaxed once. Only non-empty buckets are
+ * stored, so a tiny delta costs no memory; distances over delta that do not fit
+ * in a size_t share the last bucket, which is then emptied until it stays
+ * empty, as in Bellman-Ford. Small delta approaches
+ * Dijkstra, large delta approaches Bellman-Ford. The distances match
+ * dijkstra_shortest_paths; predecessors are picked afterwards by a breadth first
+ * search over the edges that lie on shortest paths, so they do not depend on
+ * thread timing.
+ * @param   g           the graph to search
+ * @param   s           the source vertex
+ * @param   weight      the weight of every edge, e.g. an edge_property_map;
+ *                      WeightMap::value_type is the distance type
+ * @param   delta       the bucket width; if not positive, the largest weight
+ *                      over the average out-degree is used
+ * @param   predecessor set to the previous vertex on a shortest path from s;
+ *                      s and unreached vertices are their own predecessor
+ * @param   distance    set to the length of a shortest path from s, or to
+ *                      std::numeric_limits<value_type>::max() if there is none
+ * @throws  negative_edge if some edge has a negative weight
+ */
+template <typename G, typename WeightMap>
+void delta_stepping_shortest_paths (const G& g, typename G::vertex_descriptor s, const WeightMap& weight,
+                                    typename WeightMap::value_type delta,
+                                    std::vector<typename G::vertex_descriptor>& predecessor,
+                                    std::vector<typename WeightMap::value_type>& distance) {
+    typedef typename WeightMap::value_type W;
+    const W infinity = std::numeric_limits<W>::max();
+
+    const graph_detail::weighted_csr<W> out = graph_detail::out_weighted_csr(g, weight);
+    const std::size_t                   n   = out.size();
+    assert(s < n);
+    W heaviest = W();
+    for(std::size_t i = 0; i < out.weights.size(); ++i) {
+        if(out.weights[i] < W())
+            throw negative_edge();
+        heaviest = std::max(heaviest, out.weights[i]);
+    }
+    if(!(W() < delta))
+        delta = heaviest / std::max<std::size_t>(1, out.targets.size() / std::max<std::size_t>(1, n));
+    if(!(W() < delta))
+        delta = W(1);
+
+    std::vector< std::atomic<W> > tentative(n);
+    for(std::size_t v = 0; v < n; ++v)
+        tentative[v].store(infinity, std::memory_order_relaxed);
+    tentative[s].store(W(), std::memory_order_relaxed);
+
+    // the bucket of distance d, clamped so that the cast is defined
+    auto bucket_of = [delta] (W d) -> std::size_t {
+        const W q = d / delta;
+        return static_cast<long double>(q) < static_cast<long double>(std::numeric_limits<std::size_t>::max()) ?
+               std::size_t(q) : std::numeric_limits<std::size_t>::max();
+    };
+
+    std::map< std::size_t, std::vector<std::size_t> > buckets;
+    buckets[0].push_back(s);
+    std::mutex merge;
+
+    // relaxes the light or the heavy out-edges of every vertex in frontier
+    auto relax = [&] (const std::vector<std::size_t>& frontier, bool light) {
+        graph_detail::parallel_for(frontier.size(), [&] (std::size_t b, std::size_t e) {
+            std::vector< std::pair<std::size_t, std::size_t> > local;
+            for(std::size_t i = b; i < e; ++i) {
+                const std::size_t u  = frontier[i];
+                const W           du = tentative[u].load(std::memory_order_relaxed);
+                for(std::size_t j = out.offsets[u]; j < out.offsets[u + 1]; ++j) {
+                    if((out.weights[j] <= delta) != light)
+                        continue;
+                    const W d = du + out.weights[j];
+                    if(graph_detail::atomic_min(tentative[out.targets[j]], d))
+                        local.push_back(std::make_pair(bucket_of(d), out.targets[j]));
+                }
+            }
+            std::lock_guard<std::mutex> lock(merge);
+            for(std::size_t i = 0; i < local.size(); ++i)
+                buckets[local[i].first].push_back(local[i].second);
+        }, 256);
     };
 
+    // relax never adds below the lowest bucket, and map iterators survive inserts
+    while(!buckets.empty()) {
+        const typename std::map< std::size_t, std::vector<std::size_t> >::iterator bucket = buckets.begin();
+        const std::size_t k = bucket->first;
+        std::vector<std::size_t> settled;
+        while(!bucket->second.empty()) {
+            std::vector<std::size_t> frontier;
+            frontier.swap(bucket->second);
+            std::sort(frontier.begin(), frontier.end());
+            frontier.erase(std::unique(frontier.begin(), frontier.end()), frontier.end());
+
+            // a vertex is stale here if it has since moved to a lower bucket
+            std::size_t live = 0;
+            for(std::size_t i = 0; i < frontier.size(); ++i) {
+                if(bucket_of(tentative[frontier[i]].load(std::memory_order_relaxed)) == k)
+                    frontier[live++] = frontier[i];
+            }
+            frontier.resize(live);
+            settled.insert(settled.end(), frontier.begin(), frontier.end());
+            relax(frontier, true);
+        }
+        std::sort(settled.begin(), settled.end());
+        settled.erase(std::unique(settled.begin(), settled.end()), settled.end());
+        relax(settled, false);
+        if(bucket->second.empty())
+            buckets.erase(bucket);
+    }
+
+    predecessor.resize(n);
+    distance.resize(n);
+    for(std::size_t v = 0; v < n; ++v) {
+        predecessor[v] = v;
+        distance[v]    = tentative[v].load(std::memory_order_relaxed);
+    }
+    std::vector<char> reached(n, 0);
+    std::vector<std::size_t> queue(1, s);
+    reached[s] = 1;
+    for(std::size_t i = 0; i < queue.size(); ++i) {
+        const std::size_t u = queue[i];
+        for(std::size_t j = out.offsets[u]; j < out.offsets[u + 1]; ++j) {
+            const std::size_t v = out.targets[j];
+            if(!reached[v] && distance[u] + out.weights[j] == distance[v]) {
+                reached[v]     = 1;
+                predecessor[v] = u;
+                queue.push_back(v);
+            }
+        }
+    }
+}
+
+// --------------
+// triangle_count
+// --------------
+
+/**
+ * Counts the triangles of g taken as an undirected graph: directions, self
+ * loops and repeated edges are ignored. Each vertex keeps only its neighbours of
+ * higher (degree, descriptor) rank, so each triangle is found once, at its lowest
+ * ranked vertex, by intersecting two sorted rows with the SIMD kernel the
+ * processor supports. Vertices are split across threads. Graphs with 2^32
+ * vertices or more fall back to 64-bit rows and the scalar kernel.
+ * @param   g   any graph with vertices and adjacent_vertices
+ * @returns     the number of triangles
+ */
+template <typename G>
+std::size_t triangle_count (const G& g) {
+    const graph_detail::csr out = graph_detail::out_csr(g);
+    if(out.size() <= std::numeric_limits<std::uint32_t>::max())
+        return graph_detail::count_triangles<std::uint32_t>(out);
+    return graph_detail::count_triangles<std::size_t>(out);
+}
+
+// ----------------
+// common_neighbors
+// ----------------
+
+/**
+ * @param   u   a vertex of g
+ * @param   v   another vertex of g
+ * @param   g   any graph with adjacent_vertices
+ * @returns     the number of vertices that are targets of out-edges of both u and
+ *              v; rows sorted by sort_adjacency skip a sort, and rows with a
+ *              target of 2^32 or more are intersected at 64 bits without SIMD
+ */
+template <typename G>
+std::size_t common_neighbors (typename G::vertex_descriptor u, typename G::vertex_descriptor v, const G& g) {
+    std::vector<std::uint32_t> a;
+    std::vector<std::uint32_t> b;
+    if(graph_detail::sorted_targets(u, g, a) && graph_detail::sorted_targets(v, g, b))
+        return graph_detail::intersect(a.data(), a.size(), b.data(), b.size());
+    std::vector<std::size_t> wide_a;
+    std::vector<std::size_t> wide_b;
+    graph_detail::sorted_targets(u, g, wide_a);
+    graph_detail::sorted_targets(v, g, wide_b);
+    return graph_detail::intersect(wide_a.data(), wide_a.size(), wide_b.data(), wide_b.size());
+}
+
+// --------------------
+// connected_components
+// --------------------
+
+/**
+ * Labels the weakly connected components of g: every edge of out_csr(g) is
+ * merged into a lock-free union_find, with the vertices split across threads.
+ * @param   g           any graph with vertices and adjacent_vertices
+ * @param   component   set to the component of every vertex, numbered from 0 in
+ *                      order of each component's lowest vertex; the holes left by
+ *                      removed vertices get std::numeric_limits<std::size_t>::max()
+ * @returns             the number of components
+ */
+template <typename G>
+std::size_t connected_components (const G& g, std::vector<std::size_t>& component) {
+    static const std::size_t none = std::numeric_limits<std::size_t>::max();
+    const graph_detail::csr out = graph_detail::out_csr(g);
+    const std::size_t       n   = out.size();
+
+    graph_detail::union_find sets(n);
+    graph_detail::parallel_for(n, [&] (std::size_t b, std::size_t e) {
+        for(std::size_t u = b; u < e; ++u) {
+            for(std::size_t k = out.offsets[u]; k < out.offsets[u + 1]; ++k)
+                sets.unite(u, out.targets[k]);
+        }}, 1024);
+
+    component.assign(n, none);
+    std::pair<typename G::vertex_iterator, typename G::vertex_iterator> v = vertices(g);
+    for(; v.first != v.second; ++v.first)
+        component[*v.first] = sets.find(*v.first);
+    return graph_detail::dense_labels(component, none);
+}
+
+// -----------------
+// strong_components
+// -----------------
+
+/**
+ * Labels the strongly connected components of g in three phases:
+ * 1. trim: peels off vertices with no in-edges or no out-edges left, each of
+ *    which is a component by itself;
+ * 2. forward-backward (Fleischer, Hendrickson and Pinar): the component of the
+ *    vertex with the largest in-degree * out-degree is the intersection of what it
+ *    reaches and what reaches it, found by two parallel searches; the rest splits
+ *    into three parts no component crosses;
+ * 3. coloring (Orzan): within each part, every vertex takes the largest
+ *    descriptor that reaches it, in parallel rounds; each vertex that keeps its
+ *    own descriptor roots a component, found by a backward search through its
+ *    color. Each color becomes a part and the rounds repeat on what is left.
+ * @param   g           any graph with vertices and adjacent_vertices
+ * @param   component   set to the component of every vertex, numbered from 0 in
+ *                      order of each component's lowest vertex; the holes left by
+ *                      removed vertices get std::numeric_limits<std::size_t>::max()
+ * @returns             the number of components
+ */
+template <typename G>
+std::size_t strong_components (const G& g, std::vector<std::size_t>& component) {
+    static const std::size_t none = std::numeric_limits<std::size_t>::max();
+    const graph_detail::csr out = graph_detail::out_csr(g);
+    const graph_detail::csr in  = graph_detail::transpose(out);
+    const std::size_t       n   = out.size();
+
+    // part[v] is none once v has its component
+    std::vector<std::size_t> part(n, none);
+    component.assign(n, none);
+    std::pair<typename G::vertex_iterator, typename G::vertex_iterator> vs = vertices(g);
+    for(; vs.first != vs.second; ++vs.first)
+        part[*vs.first] = 0;
+
+    // 1. trim
+    std::vector<std::size_t> in_left(n, 0);
+    std::vector<std::size_t> out_left(n, 0);
+    std::vector<std::size_t> peel;
+    for(std::size_t v = 0; v < n; ++v) {
+        if(part[v] == none)
+            continue;
+        for(std::size_t k = out.offsets[v]; k < out.offsets[v + 1]; ++k)
+            out_left[v] += out.targets[k] != v;
+        for(std::size_t k = in.offsets[v]; k < in.offsets[v + 1]; ++k)
+            in_left[v] += in.targets[k] != v;
+        if(in_left[v] == 0 || out_left[v] == 0) {
+            component[v] = v;
+            part[v]      = none;
+            peel.push_back(v);
+        }
+    }
+    while(!peel.empty()) {
+        const std::size_t v = peel.back();
+        peel.pop_back();
+        for(std::size_t k = out.offsets[v]; k < out.offsets[v + 1]; ++k) {
+            const std::size_t w = out.targets[k];
+            if(part[w] != none && --in_left[w] == 0) {
+                component[w] = w;
+                part[w]      = none;
+                peel.push_back(w);
+            }
+        }
+        for(std::size_t k = in.offsets[v]; k < in.offsets[v + 1]; ++k) {
+            const std::size_t w = in.targets[k];
+            if(part[w] != none && --out_left[w] == 0) {
+                component[w] = w;
+                part[w]      = none;
+                peel.push_back(w);
+            }
+        }
+    }
+
+    // 2. forward-backward from the best connected vertex
+    std::size_t pivot = none;
+    for(std::size_t v = 0; v < n; ++v) {
+        if(part[v] != none && (pivot == none || in_left[v] * out_left[v] > in_left[pivot] * out_left[pivot]))
+            pivot = v;
+    }
+    if(pivot != none) {
+        std::vector< std::atomic<unsigned char> > mark(n);
+        for(std::size_t v = 0; v < n; ++v)
+            mark[v].store(0, std::memory_order_relaxed);
+        graph_detail::reach(out, pivot, part, mark, 1);
+        graph_detail::reach(in,  pivot, part, mark, 2);
+        for(std::size_t v = 0; v < n; ++v) {
+            const unsigned char m = mark[v].load(std::memory_order_relaxed);
+            if(m == 3) {
+                component[v] = pivot;
+                part[v]      = none;
+            }
+            else if(m != 0)
+                part[v] = m;
+        }
+    }
+
+    // 3. coloring
+    std::vector<std::size_t> active;
+    for(std::size_t v = 0; v < n; ++v) {
+        if(part[v] != none)
+            active.push_back(v);
+    }
+    std::vector< std::atomic<std::size_t> >   color(n);
+    std::vector< std::atomic<unsigned char> > queued(n);
+    while(!active.empty()) {
+        for(std::size_t i = 0; i < active.size(); ++i) {
+            color[active[i]].store(active[i], std::memory_order_relaxed);
+            queued[active[i]].store(1, std::memory_order_relaxed);
+        }
+        std::vector<std::size_t> frontier(active);
+        std::mutex               lock;
+        while(!frontier.empty()) {
+            std::vector<std::size_t> next;
+            graph_detail::parallel_for(frontier.size(), [&] (std::size_t b, std::size_t e) {
+                std::vector<std::size_t> raised;
+                for(std::size_t i = b; i < e; ++i) {
+                    const std::size_t u = frontier[i];
+                    queued[u].store(0, std::memory_order_relaxed);
+                    const std::size_t c = color[u].load(std::memory_order_relaxed);
+                    for(std::size_t k = out.offsets[u]; k < out.offsets[u + 1]; ++k) {
+                        const std::size_t w = out.targets[k];
+                        if(part[w] == part[u] && graph_detail::atomic_max(color[w], c) &&
+                           queued[w].exchange(1, std::memory_order_relaxed) == 0)
+                            raised.push_back(w);
+                    }
+                }
+                std::lock_guard<std::mutex> guard(lock);
+                next.insert(next.end(), raised.begin(), raised.end());}, 1024);
+            frontier.swap(next);
+        }
+
+        // each root takes the vertices of its color that reach it
+        std::vector<std::size_t> roots;
+        for(std::size_t i = 0; i < active.size(); ++i) {
+            if(color[active[i]].load(std::memory_order_relaxed) == active[i])
+                roots.push_back(active[i]);
+        }
+        graph_detail::parallel_for(roots.size(), [&] (std::size_t b, std::size_t e) {
+            std::vector<std::size_t> stack;
+            for(std::size_t i = b; i < e; ++i) {
+                const std::size_t r = roots[i];
+                component[r] = r;
+                stack.push_back(r);
+                while(!stack.empty()) {
+                    const std::size_t u = stack.back();
+                    stack.pop_back();
+                    for(std::size_t k = in.offsets[u]; k < in.offsets[u + 1]; ++k) {
+                        const std::size_t w = in.targets[k];
+                        if(part[w] == part[r] && color[w].load(std::memory_order_relaxed) == r && component[w] == none) {
+                            component[w] = r;
+                            stack.push_back(w);
+                        }
+                    }
+                }
+            }}, 64);
+
+        // each color left is a part of its own
+        std::size_t left = 0;
+        for(std::size_t i = 0; i < active.size(); ++i) {
+            const std::size_t v = active[i];
+            if(component[v] != none)
+                part[v] = none;
+            else {
+                part[v]        = color[v].load(std::memory_order_relaxed);
+                active[left++] = v;
+            }
+        }
+        active.resize(left);
+    }
+    return graph_detail::dense_labels(component, none);
+}
+
 #endif // Graph_h
@@ -0,0 +1,46 @@
+// ---------------------------
+// projects/graph/GraphTypes.h
+// Copyright (C) 2014
+// Glenn P. Downing
+// ---------------------------
+
+/*
+The graph types that TestGraph.c++ checks against each other and that
+BenchGraph.c++ times, so that both always cover the same list.
+*/
+
+#ifndef GraphTypes_h
+#define GraphTypes_h
+
+// --------
+// includes
+// --------
+
+#include <cstdint> // uint32_t
+
+#include "boost/graph/adjacency_list.hpp" // adjacency_list
+
+#include "Graph.h"
+
+// --------
+// typedefs
+// --------
+
+typedef boost::adjacency_list<boost::setS, boost::vecS, boost::directedS> boost_graph;
+
+// 32-bit descriptors, no edge list
+typedef basic_graph<std::uint32_t, false> slim_graph;
+
+// ----------
+// graph_list
+// ----------
+
+template <typename... Gs>
+struct graph_list {};
+
+// directed, sparse, unweighted
+// possibly connected
+// possibly cyclic
+typedef graph_list<boost_graph, Graph, slim_graph, CompactGraph> graph_types;
+
+#endif // GraphTypes_h
@@ -37,17 +37,28 @@ To obtain coverage of the test:
 // includes
 // --------
 
-#include <iostream> // cout, endl
-#include <iterator> // ostream_iterator
-#include <sstream>  // ostringstream
-#include <utility>  // pair
+#include <algorithm> // sort
+#include <cstdio>    // remove
+#include <fstream>   // ofstream
+#include <iostream>  // cout, endl
+#include <iterator>  // ostream_iterator
+#include <limits>    // numeric_limits
+#include <sstream>   // ostringstream
+#include <stdexcept> // runtime_error
+#include <thread>    // thread
+#include <utility>   // pair
+#include <vector>    // vector
 
 #include "boost/graph/adjacency_list.hpp"  // adjacency_list
+#include "boost/graph/connected_components.hpp" // connected_components
+#include "boost/graph/dijkstra_shortest_paths.hpp" // dijkstra_shortest_paths
+#include "boost/graph/strong_components.hpp" // strong_components
 #include "boost/graph/topological_sort.hpp"// topological_sort
 
 #include "gtest/gtest.h"
 
 #include "Graph.h"
+#include "GraphTypes.h"
 
 // ---------
 // TestGraph
@@ -77,13 +88,15 @@ struct TestGraph : testing::Test {
                         typedef typename TestFixture::vertices_size_type vertices_size_type; \
                         typedef typename TestFixture::edges_size_type    edges_size_type;
 
-// directed, sparse, unweighted
-// possibly connected
-// possibly cyclic
-typedef testing::Types<
-            boost::adjacency_list<boost::setS, boost::vecS, boost::directedS>,
-            Graph>
-        my_types;
+template <typename L>
+struct test_types;
+
+template <typename... Gs>
+struct test_types< graph_list<Gs...> > {
+    typedef testing::Types<Gs...> type;};
+
+// the graph_types of GraphTypes.h
+typedef test_types<graph_types>::type my_types;
 
 TYPED_TEST_CASE(TestGraph, my_types);
 
@@ -134,6 +147,24 @@ TYPED_TEST(TestGraph, add_edge_3) {
     edges_size_type es = num_edges(g);
     ASSERT_EQ(2, es);
 }
+TYPED_TEST(TestGraph, add_edge_4) {
+    ALL_OF_IT
+    
+    graph_type g;
+    
+    vertex_descriptor vdHub = add_vertex(g);
+    for(int i = 0; i < 100; ++i)
+        add_vertex(g);
+    
+    for(int i = 1; i <= 100; ++i)
+        ASSERT_EQ(true, add_edge(vdHub, i, g).second);
+    for(int i = 100; i >= 1; --i)
+        ASSERT_EQ(false, add_edge(vdHub, i, g).second);
+    ASSERT_EQ(true, add_edge(vdHub, vdHub, g).second);
+    
+    edges_size_type es = num_edges(g);
+    ASSERT_EQ(101, es);
+}
 TYPED_TEST(TestGraph, add_vertex_1) {
     ALL_OF_IT
     
@@ -369,6 +400,26 @@ TYPED_TEST(TestGraph, edge_3) {
     ASSERT_EQ(edAC, p3.first);
     ASSERT_EQ(true, p3.second);
 }
+TYPED_TEST(TestGraph, edge_4) {
+    ALL_OF_IT
+    
+    graph_type g;
+    
+    vertex_descriptor vdHub = add_vertex(g);
+    std::vector<edge_descriptor> eds;
+    for(int i = 0; i < 100; ++i)
+        eds.push_back(add_edge(vdHub, add_vertex(g), g).first);
+    
+    for(int i = 0; i < 100; ++i) {
+        std::pair<edge_descriptor, bool> p = edge(vdHub, i + 1, g);
+        ASSERT_EQ(true, p.second);
+        ASSERT_EQ(eds[i], p.first);
+        ASSERT_EQ(vdHub, source(p.first, g));
+        ASSERT_EQ(i + 1, target(p.first, g));
+    }
+    ASSERT_EQ(false, edge(vdHub, vdHub, g).second);
+    ASSERT_EQ(false, edge(1, vdHub, g).second);
+}
 
 
 
@@ -1524,4 +1575,1721 @@ TYPED_TEST(TestGraph, adj_vert_iter_inc_3) {
     adjacency_iterator                             e = p.second;
     
     ASSERT_TRUE(++b != e);
-}
\ No newline at end of file
+}
+
+// ----------------
+// TestCompactGraph
+// ----------------
+
+TEST(TestCompactGraph, freeze_1) {
+    Graph g;
+    CompactGraph c = freeze(g);
+    ASSERT_EQ(0, num_vertices(c));
+    ASSERT_EQ(0, num_edges(c));
+    ASSERT_TRUE(edges(c).first == edges(c).second);
+}
+TEST(TestCompactGraph, freeze_2) {
+    Graph g;
+    Graph::vertex_descriptor vdA = add_vertex(g);
+    Graph::vertex_descriptor vdB = add_vertex(g);
+    Graph::vertex_descriptor vdC = add_vertex(g);
+
+    Graph::edge_descriptor edBC = add_edge(vdB, vdC, g).first;
+    Graph::edge_descriptor edAC = add_edge(vdA, vdC, g).first;
+    Graph::edge_descriptor edAB = add_edge(vdA, vdB, g).first;
+
+    CompactGraph c = freeze(g);
+    ASSERT_EQ(3, num_vertices(c));
+    ASSERT_EQ(3, num_edges(c));
+
+    ASSERT_EQ(vdB, source(edBC, c));
+    ASSERT_EQ(vdC, target(edBC, c));
+    ASSERT_EQ(vdA, source(edAC, c));
+    ASSERT_EQ(vdC, target(edAC, c));
+    ASSERT_EQ(edAB, edge(vdA, vdB, c).first);
+    ASSERT_FALSE(edge(vdC, vdA, c).second);
+
+    // rows are sorted by target
+    std::pair<CompactGraph::adjacency_iterator, CompactGraph::adjacency_iterator> p = adjacent_vertices(vdA, c);
+    ASSERT_EQ(vdB, *p.first);
+    ++p.first;
+    ASSERT_EQ(vdC, *p.first);
+    ++p.first;
+    ASSERT_TRUE(p.first == p.second);
+}
+TEST(TestCompactGraph, freeze_3) {
+    Graph g;
+    for(int i = 0; i < 50; ++i)
+        add_vertex(g);
+    for(int i = 0; i < 50; ++i)
+        for(int j = 0; j < 50; j += i + 1)
+            add_edge(i, j, g);
+
+    CompactGraph c = freeze(g);
+    ASSERT_EQ(num_vertices(g), num_vertices(c));
+    ASSERT_EQ(num_edges(g), num_edges(c));
+
+    std::pair<Graph::edge_iterator, Graph::edge_iterator> p = edges(g);
+    for(; p.first != p.second; ++p.first) {
+        ASSERT_EQ(source(*p.first, g), source(*p.first, c));
+        ASSERT_EQ(target(*p.first, g), target(*p.first, c));
+    }
+}
+TEST(TestCompactGraph, add_edge_1) {
+    Graph g;
+    Graph::vertex_descriptor vdA = add_vertex(g);
+    Graph::vertex_descriptor vdB = add_vertex(g);
+    Graph::vertex_descriptor vdC = add_vertex(g);
+    add_edge(vdB, vdC, g);
+
+    CompactGraph c = freeze(g);
+    CompactGraph::edge_descriptor edAB = add_edge(vdA, vdB, c).first;
+    CompactGraph::edge_descriptor edCA = add_edge(vdC, vdA, c).first;
+
+    ASSERT_EQ(3, num_edges(c));
+    ASSERT_EQ(vdA, source(edAB, c));
+    ASSERT_EQ(vdB, target(edAB, c));
+    ASSERT_EQ(vdC, source(edCA, c));
+    ASSERT_EQ(vdB, source(0, c));
+    ASSERT_EQ(vdC, target(0, c));
+}
+TEST(TestCompactGraph, edge_1) {
+    // a hub whose targets arrive shuffled, then one more edge into the middle
+    Graph g;
+    const int n = 200;
+    for(int i = 0; i < n; ++i)
+        add_vertex(g);
+    for(int i = 0; i < n; ++i)
+        add_edge(0, (i * 37) % n, g);
+    for(int i = 1; i < n; i += 3)
+        add_edge(i, 0, g);
+
+    CompactGraph c = freeze(g);
+    for(int i = 0; i < n; ++i) {
+        ASSERT_EQ(edge(0, i, g).first, edge(0, i, c).first);
+        ASSERT_EQ(i % 3 == 1 || i == 0, edge(i, 0, c).second);
+    }
+    remove_edge(0, 100, g);
+    c = freeze(g);
+    ASSERT_FALSE(edge(0, 100, c).second);
+    CompactGraph::edge_descriptor ed = add_edge(0, 100, c).first;
+    ASSERT_EQ(ed, edge(0, 100, c).first);
+    ASSERT_EQ(100, target(ed, c));
+    std::vector<std::size_t> row;
+    std::pair<CompactGraph::adjacency_iterator, CompactGraph::adjacency_iterator> p = adjacent_vertices(0, c);
+    for(; p.first != p.second; ++p.first)
+        row.push_back(*p.first);
+    ASSERT_EQ(n, row.size());
+    ASSERT_TRUE(std::is_sorted(row.begin(), row.end()));
+}
+TEST(TestCompactGraph, map_graph_1) {
+    Graph g;
+    save_graph(g, "TestGraph.tmp");
+    CompactGraph c = map_graph("TestGraph.tmp");
+    std::remove("TestGraph.tmp");
+    ASSERT_EQ(0, num_vertices(c));
+    ASSERT_EQ(0, num_edges(c));
+    ASSERT_TRUE(vertices(c).first == vertices(c).second);
+}
+TEST(TestCompactGraph, map_graph_2) {
+    Graph g;
+    for(int i = 0; i < 50; ++i)
+        add_vertex(g);
+    for(int i = 0; i < 50; ++i)
+        for(int j = 49; j >= 0; j -= i + 1)
+            add_edge(i, j, g);
+    save_graph(g, "TestGraph.tmp");
+    CompactGraph c = map_graph("TestGraph.tmp");
+    std::remove("TestGraph.tmp");
+
+    ASSERT_EQ(num_vertices(g), num_vertices(c));
+    ASSERT_EQ(num_edges(g), num_edges(c));
+    std::pair<Graph::edge_iterator, Graph::edge_iterator> p = edges(g);
+    for(; p.first != p.second; ++p.first) {
+        ASSERT_EQ(source(*p.first, g), source(*p.first, c));
+        ASSERT_EQ(target(*p.first, g), target(*p.first, c));
+        ASSERT_EQ(*p.first, edge(source(*p.first, g), target(*p.first, g), c).first);
+    }
+    sort_adjacency(g);
+    for(int v = 0; v < 50; ++v) {
+        std::pair<Graph::adjacency_iterator, Graph::adjacency_iterator> a = adjacent_vertices(v, g);
+        std::pair<CompactGraph::adjacency_iterator, CompactGraph::adjacency_iterator> b = adjacent_vertices(v, c);
+        for(; a.first != a.second; ++a.first, ++b.first)
+            ASSERT_EQ(*a.first, *b.first);
+        ASSERT_TRUE(b.first == b.second);
+    }
+
+    CompactGraph d = c;
+    CompactGraph::vertex_descriptor vd = add_vertex(d);
+    ASSERT_EQ(true, add_edge(vd, 0, d).second);
+    ASSERT_EQ(num_edges(g) + 1, num_edges(d));
+    ASSERT_EQ(num_edges(g), num_edges(c));
+}
+TEST(TestCompactGraph, map_graph_3) {
+    std::ofstream out("TestGraph.tmp");
+    out << "0 1\n1 2\n";
+    out.close();
+    ASSERT_THROW(map_graph("TestGraph.tmp"), std::runtime_error);
+    std::remove("TestGraph.tmp");
+    ASSERT_THROW(map_graph("TestGraph.tmp"), std::runtime_error);
+}
+TEST(TestCompactGraph, map_graph_4) {
+    // overwrites word i after the header: offsets come first, then targets
+    auto corrupt = [] (std::size_t i, std::size_t value) {
+        std::fstream file("TestGraph.tmp", std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(sizeof(graph_detail::graph_header) + i * sizeof(std::size_t));
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+    Graph g;
+    for(int i = 0; i < 4; ++i)
+        add_vertex(g);
+    add_edge(0, 1, g);
+    add_edge(1, 2, g);
+    add_edge(2, 3, g);
+    add_edge(0, 2, g);
+
+    save_graph(g, "TestGraph.tmp");
+    corrupt(2, 7);
+    ASSERT_THROW(map_graph("TestGraph.tmp"), std::runtime_error);
+    save_graph(g, "TestGraph.tmp");
+    corrupt(0, 1);
+    ASSERT_THROW(map_graph("TestGraph.tmp"), std::runtime_error);
+    save_graph(g, "TestGraph.tmp");
+    corrupt(5 + 1, 4);
+    ASSERT_THROW(map_graph("TestGraph.tmp"), std::runtime_error);
+    save_graph(g, "TestGraph.tmp");
+    corrupt(5, 3);
+    ASSERT_THROW(map_graph("TestGraph.tmp"), std::runtime_error);
+    save_graph(g, "TestGraph.tmp");
+    ASSERT_EQ(4, num_edges(map_graph("TestGraph.tmp")));
+    std::remove("TestGraph.tmp");
+}
+
+// -------------
+// TestGraphBulk
+// -------------
+
+TEST(TestGraphBulk, add_edges_1) {
+    Graph g;
+    add_vertex(g);
+    add_vertex(g);
+    std::vector< std::pair<Graph::vertex_descriptor, Graph::vertex_descriptor> > v;
+    ASSERT_EQ(0, add_edges(v.begin(), v.end(), g));
+    ASSERT_EQ(0, num_edges(g));
+}
+TEST(TestGraphBulk, add_edges_2) {
+    Graph g;
+    Graph::vertex_descriptor vdA = add_vertex(g);
+    Graph::vertex_descriptor vdB = add_vertex(g);
+    Graph::vertex_descriptor vdC = add_vertex(g);
+    Graph::edge_descriptor edBA = add_edge(vdB, vdA, g).first;
+
+    std::vector< std::pair<Graph::vertex_descriptor, Graph::vertex_descriptor> > v;
+    v.push_back(std::make_pair(vdC, vdA));
+    v.push_back(std::make_pair(vdB, vdA));
+    v.push_back(std::make_pair(vdA, vdB));
+    v.push_back(std::make_pair(vdC, vdA));
+    ASSERT_EQ(2, add_edges(v.begin(), v.end(), g));
+    ASSERT_EQ(3, num_edges(g));
+
+    ASSERT_EQ(edBA, edge(vdB, vdA, g).first);
+    ASSERT_EQ(edBA + 1, edge(vdC, vdA, g).first);
+    ASSERT_EQ(edBA + 2, edge(vdA, vdB, g).first);
+}
+TEST(TestGraphBulk, add_edges_3) {
+    Graph g1;
+    Graph g2;
+    reserve_vertices(1000, g2);
+    reserve_edges(50000, g2);
+    for(int i = 0; i < 1000; ++i) {
+        add_vertex(g1);
+        add_vertex(g2);
+    }
+
+    std::vector< std::pair<Graph::vertex_descriptor, Graph::vertex_descriptor> > v;
+    unsigned int x = 12345;
+    for(int i = 0; i < 50000; ++i) {
+        x = x * 1103515245 + 12345;
+        Graph::vertex_descriptor s = (i % 3 == 0) ? 7 : (x >> 8) % 1000;
+        x = x * 1103515245 + 12345;
+        v.push_back(std::make_pair(s, Graph::vertex_descriptor((x >> 8) % 1000)));
+    }
+    for(std::size_t i = 0; i < v.size(); ++i)
+        add_edge(v[i].first, v[i].second, g1);
+    add_edges(v.begin(), v.end(), g2);
+
+    ASSERT_EQ(num_edges(g1), num_edges(g2));
+    std::pair<Graph::edge_iterator, Graph::edge_iterator> p = edges(g1);
+    for(; p.first != p.second; ++p.first) {
+        ASSERT_EQ(source(*p.first, g1), source(*p.first, g2));
+        ASSERT_EQ(target(*p.first, g1), target(*p.first, g2));
+    }
+    std::pair<Graph::adjacency_iterator, Graph::adjacency_iterator> a1 = adjacent_vertices(7, g1);
+    std::pair<Graph::adjacency_iterator, Graph::adjacency_iterator> a2 = adjacent_vertices(7, g2);
+    for(; a1.first != a1.second; ++a1.first, ++a2.first)
+        ASSERT_EQ(*a1.first, *a2.first);
+    ASSERT_TRUE(a2.first == a2.second);
+}
+
+// ------------------
+// TestGraphEdgeList
+// ------------------
+
+TEST(TestGraphEdgeList, read_edge_list_1) {
+    std::ofstream out("TestGraph.tmp");
+    out << "# Directed graph: example.txt\n# FromNodeId\tToNodeId\n"
+        << "100\t7\n7\t42\n\n100\t42\r\n7\t42\n42 42";
+    out.close();
+
+    Graph g;
+    add_vertex(g);
+    edge_list_stats stats = read_edge_list("TestGraph.tmp", g);
+    std::remove("TestGraph.tmp");
+
+    ASSERT_EQ(5, stats.lines);
+    ASSERT_EQ(4, stats.edges);
+    ASSERT_EQ(1, stats.first_vertex);
+    ASSERT_EQ(3, stats.ids.size());
+    ASSERT_EQ(100, stats.ids[0]);
+    ASSERT_EQ(7,   stats.ids[1]);
+    ASSERT_EQ(42,  stats.ids[2]);
+    ASSERT_TRUE(stats.bytes_per_second() >= 0);
+
+    ASSERT_EQ(4, num_vertices(g));
+    ASSERT_EQ(4, num_edges(g));
+    ASSERT_TRUE(edge(1, 2, g).second);
+    ASSERT_TRUE(edge(2, 3, g).second);
+    ASSERT_TRUE(edge(1, 3, g).second);
+    ASSERT_TRUE(edge(3, 3, g).second);
+}
+TEST(TestGraphEdgeList, read_edge_list_2) {
+    std::ofstream out("TestGraph.tmp");
+    out << "%%MatrixMarket matrix coordinate real symmetric\n% comment\n"
+        << "3 3 3\n1 2 0.5\n3 1 1.5\n2 2 2.5\n";
+    out.close();
+
+    Graph g;
+    edge_list_stats stats = read_edge_list("TestGraph.tmp", g);
+    std::remove("TestGraph.tmp");
+
+    ASSERT_EQ(3, stats.lines);
+    ASSERT_EQ(5, stats.edges);
+    ASSERT_EQ(3, num_vertices(g));
+    ASSERT_TRUE(edge(0, 1, g).second);
+    ASSERT_TRUE(edge(1, 0, g).second);
+    ASSERT_TRUE(edge(2, 0, g).second);
+    ASSERT_TRUE(edge(0, 2, g).second);
+    ASSERT_TRUE(edge(1, 1, g).second);
+}
+TEST(TestGraphEdgeList, read_edge_list_3) {
+    std::ofstream out("TestGraph.tmp");
+    out << "1 2\n3\n";
+    out.close();
+
+    Graph g;
+    ASSERT_THROW(read_edge_list("TestGraph.tmp", g), std::runtime_error);
+    const char *bad[] = {"1 2x\n3 4\n", "1 2.5\n", "1x 2\n"};
+    for(int i = 0; i < 3; ++i) {
+        out.open("TestGraph.tmp");
+        out << bad[i];
+        out.close();
+        ASSERT_THROW(read_edge_list("TestGraph.tmp", g), std::runtime_error);
+    }
+    ASSERT_EQ(0, num_vertices(g));
+    std::remove("TestGraph.tmp");
+    ASSERT_THROW(read_edge_list("TestGraph.tmp", g), std::runtime_error);
+}
+TEST(TestGraphEdgeList, read_edge_list_4) {
+    // 2^64 - 1 is the largest id; one more overflows
+    std::ofstream out("TestGraph.tmp");
+    out << "18446744073709551615 0\n";
+    out.close();
+    Graph g;
+    edge_list_stats stats = read_edge_list("TestGraph.tmp", g);
+    ASSERT_EQ(std::numeric_limits<std::uint64_t>::max(), stats.ids[0]);
+    ASSERT_TRUE(stats.parse_seconds <= stats.seconds);
+
+    out.open("TestGraph.tmp");
+    out << "0 1\n18446744073709551616 0\n";
+    out.close();
+    ASSERT_THROW(read_edge_list("TestGraph.tmp", g), std::runtime_error);
+    out.open("TestGraph.tmp");
+    out << "0 99999999999999999999\n";
+    out.close();
+    ASSERT_THROW(read_edge_list("TestGraph.tmp", g), std::runtime_error);
+    std::remove("TestGraph.tmp");
+    ASSERT_EQ(2, num_vertices(g));
+}
+
+// ------------------
+// TestGraphAlgorithm
+// ------------------
+
+TEST(TestGraphAlgorithm, breadth_first_search_1) {
+    Graph g;
+    Graph::vertex_descriptor vdA = add_vertex(g);
+    Graph::vertex_descriptor vdB = add_vertex(g);
+    Graph::vertex_descriptor vdC = add_vertex(g);
+    Graph::vertex_descriptor vdD = add_vertex(g);
+    add_edge(vdA, vdB, g);
+    add_edge(vdB, vdC, g);
+    add_edge(vdA, vdC, g);
+    add_edge(vdD, vdA, g);
+
+    std::vector<Graph::vertex_descriptor> parent;
+    std::vector<std::size_t>              distance;
+    breadth_first_search(g, vdA, parent, distance);
+
+    ASSERT_EQ(0, distance[vdA]);
+    ASSERT_EQ(1, distance[vdB]);
+    ASSERT_EQ(1, distance[vdC]);
+    ASSERT_EQ(std::numeric_limits<std::size_t>::max(), distance[vdD]);
+    ASSERT_EQ(vdA, parent[vdA]);
+    ASSERT_EQ(vdA, parent[vdB]);
+    ASSERT_EQ(vdA, parent[vdC]);
+    ASSERT_EQ(vdD, parent[vdD]);
+}
+TEST(TestGraphAlgorithm, breadth_first_search_2) {
+    Graph g;
+    for(int i = 0; i < 1001; ++i)
+        add_vertex(g);
+    for(int i = 1; i <= 1000; ++i) {
+        add_edge(0, i, g);
+        add_edge(i, 0, g);
+        if(i < 1000)
+            add_edge(i, i + 1, g);
+    }
+
+    std::vector<Graph::vertex_descriptor> parent;
+    std::vector<std::size_t>              distance;
+    breadth_first_search(freeze(g), 5, parent, distance);
+
+    ASSERT_EQ(0, distance[5]);
+    ASSERT_EQ(1, distance[0]);
+    ASSERT_EQ(1, distance[6]);
+    for(int i = 7; i <= 1000; ++i)
+        ASSERT_EQ(2, distance[i]);
+    ASSERT_EQ(2, distance[1]);
+    ASSERT_EQ(0, parent[1]);
+    ASSERT_EQ(5, parent[0]);
+}
+TEST(TestGraphAlgorithm, breadth_first_search_3) {
+    Graph g;
+    const int n = 2000;
+    for(int i = 0; i < n; ++i)
+        add_vertex(g);
+    unsigned int x = 7;
+    for(int i = 0; i < 6 * n; ++i) {
+        x = x * 1103515245 + 12345;
+        Graph::vertex_descriptor s = (x >> 8) % n;
+        x = x * 1103515245 + 12345;
+        add_edge(s, (x >> 8) % (i % 5 == 0 ? 20 : n), g);
+    }
+
+    std::vector<Graph::vertex_descriptor> parent;
+    std::vector<std::size_t>              distance;
+    breadth_first_search(g, 0, parent, distance);
+
+    std::vector<std::size_t> expected(n, std::numeric_limits<std::size_t>::max());
+    std::vector<Graph::vertex_descriptor> queue(1, 0);
+    expected[0] = 0;
+    for(std::size_t i = 0; i < queue.size(); ++i) {
+        std::pair<Graph::adjacency_iterator, Graph::adjacency_iterator> p = adjacent_vertices(queue[i], g);
+        for(; p.first != p.second; ++p.first) {
+            if(expected[*p.first] == std::numeric_limits<std::size_t>::max()) {
+                expected[*p.first] = expected[queue[i]] + 1;
+                queue.push_back(*p.first);
+            }
+        }
+    }
+    for(int v = 0; v < n; ++v) {
+        ASSERT_EQ(expected[v], distance[v]);
+        if(v != 0 && distance[v] != std::numeric_limits<std::size_t>::max()) {
+            ASSERT_EQ(distance[v] - 1, distance[parent[v]]);
+            ASSERT_TRUE(edge(parent[v], v, g).second);
+        }
+    }
+}
+TEST(TestGraphAlgorithm, topological_sort_1) {
+    Graph g;
+    Graph::vertex_descriptor vdA = add_vertex(g);
+    Graph::vertex_descriptor vdB = add_vertex(g);
+    Graph::vertex_descriptor vdC = add_vertex(g);
+    add_edge(vdA, vdC, g);
+    add_edge(vdC, vdB, g);
+
+    std::vector<Graph::vertex_descriptor> order;
+    topological_sort(g, std::back_inserter(order));
+    ASSERT_EQ(3, order.size());
+    ASSERT_EQ(vdB, order[0]);
+    ASSERT_EQ(vdC, order[1]);
+    ASSERT_EQ(vdA, order[2]);
+    ASSERT_FALSE(has_cycle(g));
+
+    std::vector<Graph::vertex_descriptor> parallel_order;
+    parallel_topological_sort(g, std::back_inserter(parallel_order));
+    ASSERT_TRUE(order == parallel_order);
+}
+TEST(TestGraphAlgorithm, topological_sort_2) {
+    Graph g;
+    Graph::vertex_descriptor vdA = add_vertex(g);
+    Graph::vertex_descriptor vdB = add_vertex(g);
+    Graph::vertex_descriptor vdC = add_vertex(g);
+    add_edge(vdA, vdB, g);
+    add_edge(vdB, vdC, g);
+    add_edge(vdC, vdA, g);
+
+    std::vector<Graph::vertex_descriptor> order;
+    ASSERT_THROW(topological_sort(g, std::back_inserter(order)), not_a_dag);
+    ASSERT_THROW(parallel_topological_sort(g, std::back_inserter(order)), not_a_dag);
+    ASSERT_TRUE(order.empty());
+    ASSERT_TRUE(has_cycle(g));
+
+    Graph h;
+    add_edge(add_vertex(h), 0, h);
+    ASSERT_TRUE(has_cycle(h));
+}
+TEST(TestGraphAlgorithm, topological_sort_3) {
+    typedef boost::adjacency_list<boost::setS, boost::vecS, boost::directedS> boost_graph;
+    const int n = 100000;
+    Graph       g;
+    boost_graph b;
+    for(int i = 0; i < n; ++i) {
+        add_vertex(g);
+        add_vertex(b);
+    }
+    unsigned int x = 11;
+    for(int i = 1; i < n; ++i) {
+        x = x * 1103515245 + 12345;
+        Graph::vertex_descriptor u = (x >> 8) % i;
+        add_edge(i - 1, i, g);
+        add_edge(u, i, g);
+        add_edge(i - 1, i, b);
+        add_edge(u, i, b);
+    }
+
+    std::vector<Graph::vertex_descriptor> expected;
+    std::vector<Graph::vertex_descriptor> order;
+    std::vector<Graph::vertex_descriptor> parallel_order;
+    boost::topological_sort(b, std::back_inserter(expected));
+    topological_sort(g, std::back_inserter(order));
+    parallel_topological_sort(freeze(g), std::back_inserter(parallel_order));
+
+    // the long path through every vertex admits only one order
+    ASSERT_TRUE(expected == order);
+    ASSERT_TRUE(expected == parallel_order);
+}
+TEST(TestGraphAlgorithm, edge_property_map_1) {
+    slim_graph g;
+    slim_graph::vertex_descriptor vdA = add_vertex(g);
+    slim_graph::vertex_descriptor vdB = add_vertex(g);
+    slim_graph::edge_descriptor   edAB = add_edge(vdA, vdB, g).first;
+
+    edge_property_map<slim_graph, double> weight(g, 1.5);
+    ASSERT_EQ(1, weight.data().size());
+    ASSERT_EQ(1.5, weight[edAB]);
+    put(weight, edAB, 2.5);
+    ASSERT_EQ(2.5, get(weight, edAB));
+
+    slim_graph::edge_descriptor edBA = add_edge(vdB, vdA, g).first;
+    const edge_property_map<slim_graph, double>& view = weight;
+    ASSERT_EQ(1.5, view[edBA]);
+    ASSERT_EQ(1, weight.data().size());
+    weight[edBA] = 4;
+    ASSERT_EQ(2, weight.data().size());
+    ASSERT_EQ(2.5, weight.data()[edge_index(edAB, g)]);
+    ASSERT_EQ(4,   weight.data()[edge_index(edBA, g)]);
+}
+TEST(TestGraphAlgorithm, dijkstra_shortest_paths_1) {
+    Graph g;
+    for(int i = 0; i < 5; ++i)
+        add_vertex(g);
+    edge_property_map<Graph, int> weight(g);
+    weight[add_edge(0, 1, g).first] = 10;
+    weight[add_edge(0, 2, g).first] = 3;
+    weight[add_edge(2, 1, g).first] = 4;
+    weight[add_edge(1, 3, g).first] = 2;
+    weight[add_edge(2, 3, g).first] = 9;
+    weight[add_edge(4, 0, g).first] = 1;
+
+    std::vector<Graph::vertex_descriptor> predecessor;
+    std::vector<int>                      distance;
+    dijkstra_shortest_paths(g, 0, weight, predecessor, distance);
+    ASSERT_EQ(0, distance[0]);
+    ASSERT_EQ(7, distance[1]);
+    ASSERT_EQ(3, distance[2]);
+    ASSERT_EQ(9, distance[3]);
+    ASSERT_EQ(std::numeric_limits<int>::max(), distance[4]);
+    ASSERT_EQ(0, predecessor[0]);
+    ASSERT_EQ(2, predecessor[1]);
+    ASSERT_EQ(0, predecessor[2]);
+    ASSERT_EQ(1, predecessor[3]);
+    ASSERT_EQ(4, predecessor[4]);
+
+    std::vector<Graph::vertex_descriptor> parallel_predecessor;
+    std::vector<int>                      parallel_distance;
+    delta_stepping_shortest_paths(g, 0, weight, 3, parallel_predecessor, parallel_distance);
+    ASSERT_TRUE(distance == parallel_distance);
+    ASSERT_TRUE(predecessor == parallel_predecessor);
+
+    weight[edge(2, 3, g).first] = -1;
+    ASSERT_THROW(dijkstra_shortest_paths(g, 0, weight, predecessor, distance), negative_edge);
+    ASSERT_THROW(delta_stepping_shortest_paths(g, 0, weight, 0, predecessor, distance), negative_edge);
+}
+TEST(TestGraphAlgorithm, dijkstra_shortest_paths_2) {
+    typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS, boost::no_property,
+                                  boost::property<boost::edge_weight_t, double> > boost_graph;
+    const int n = 3000;
+    slim_graph  g;
+    boost_graph b(n);
+    for(int i = 0; i < n; ++i)
+        add_vertex(g);
+    edge_property_map<slim_graph, double> weight(g);
+    unsigned int x = 5;
+    for(int i = 0; i < 8 * n; ++i) {
+        x = x * 1103515245 + 12345;
+        slim_graph::vertex_descriptor u = (x >> 8) % n;
+        x = x * 1103515245 + 12345;
+        slim_graph::vertex_descriptor v = (x >> 8) % (i % 7 == 0 ? 50 : n);
+        x = x * 1103515245 + 12345;
+        const double w = ((x >> 8) % 1000) / 8.0;
+        std::pair<slim_graph::edge_descriptor, bool> added = add_edge(u, v, g);
+        if(added.second) {
+            weight[added.first] = w;
+            add_edge(u, v, w, b);
+        }
+    }
+
+    std::vector<boost_graph::vertex_descriptor> expected_predecessor(n);
+    std::vector<double>                         expected(n);
+    boost::dijkstra_shortest_paths(b, 0, boost::predecessor_map(&expected_predecessor[0]).distance_map(&expected[0]));
+
+    std::vector<slim_graph::vertex_descriptor> predecessor;
+    std::vector<double>                        distance;
+    dijkstra_shortest_paths(g, 0, weight, predecessor, distance);
+    ASSERT_TRUE(expected == distance);
+
+    std::vector<slim_graph::vertex_descriptor> parallel_predecessor;
+    std::vector<double>                        parallel_distance;
+    delta_stepping_shortest_paths(g, 0, weight, 0.0, parallel_predecessor, parallel_distance);
+    ASSERT_TRUE(expected == parallel_distance);
+    for(int v = 1; v < n; ++v) {
+        if(distance[v] == std::numeric_limits<double>::max())
+            continue;
+        ASSERT_EQ(distance[v], distance[predecessor[v]] + weight[edge(predecessor[v], v, g).first]);
+        ASSERT_EQ(distance[v], distance[parallel_predecessor[v]] + weight[edge(parallel_predecessor[v], v, g).first]);
+    }
+}
+TEST(TestGraphAlgorithm, dijkstra_shortest_paths_3) {
+    Graph g;
+    for(int i = 0; i < 6; ++i)
+        add_vertex(g);
+    for(int i = 0; i < 6; ++i)
+        add_edge(i, (i + 1) % 6, g);
+    add_edge(0, 3, g);
+    remove_vertex(4, g);
+
+    CompactGraph c = freeze(g);
+    edge_property_map<CompactGraph, unsigned> weight(c, 1);
+    weight[edge(0, 3, c).first] = 0;
+    weight[edge(1, 2, c).first] = 0;
+
+    std::vector<CompactGraph::vertex_descriptor> predecessor;
+    std::vector<unsigned>                        distance;
+    dijkstra_shortest_paths(c, 4, weight, predecessor, distance);
+    std::vector<CompactGraph::vertex_descriptor> parallel_predecessor;
+    std::vector<unsigned>                        parallel_distance;
+    delta_stepping_shortest_paths(c, 4, weight, 1u, parallel_predecessor, parallel_distance);
+
+    // compacting renumbered 5 to 4, so the cycle is now 4 -> 0 -> 1 -> 2 -> 3
+    ASSERT_TRUE(distance == parallel_distance);
+    ASSERT_TRUE(predecessor == parallel_predecessor);
+    ASSERT_EQ(5, distance.size());
+    ASSERT_EQ(0, distance[4]);
+    ASSERT_EQ(1, distance[0]);
+    ASSERT_EQ(2, distance[1]);
+    ASSERT_EQ(2, distance[2]);
+    ASSERT_EQ(1, distance[3]);
+    ASSERT_EQ(0, predecessor[3]);
+    ASSERT_EQ(1, predecessor[2]);
+
+    dijkstra_shortest_paths(c, 3, weight, predecessor, distance);
+    ASSERT_EQ(std::numeric_limits<unsigned>::max(), distance[0]);
+    ASSERT_EQ(0, distance[3]);
+}
+TEST(TestGraphAlgorithm, dijkstra_shortest_paths_4) {
+    // a tiny delta gives bucket numbers far past memory, and past size_t
+    const int n = 2000;
+    slim_graph g;
+    for(int i = 0; i < n; ++i)
+        add_vertex(g);
+    for(int i = 0; i + 1 < n; ++i)
+        add_edge(i, i + 1, g);
+    add_edge(0, n / 2, g);
+    edge_property_map<slim_graph, double> weight(g, 1.0);
+    weight[edge(0, n / 2, g).first] = 1e6;
+
+    std::vector<slim_graph::vertex_descriptor> predecessor;
+    std::vector<double>                        distance;
+    dijkstra_shortest_paths(g, 0, weight, predecessor, distance);
+    const double deltas[] = {1e-9, 1e-300};
+    for(int i = 0; i < 2; ++i) {
+        std::vector<slim_graph::vertex_descriptor> parallel_predecessor;
+        std::vector<double>                        parallel_distance;
+        delta_stepping_shortest_paths(g, 0, weight, deltas[i], parallel_predecessor, parallel_distance);
+        ASSERT_TRUE(distance == parallel_distance);
+        ASSERT_TRUE(predecessor == parallel_predecessor);
+        ASSERT_EQ(n - 1, parallel_distance[n - 1]);
+    }
+}
+
+// ----------------------
+// TestGraphBidirectional
+// ----------------------
+
+TEST(TestGraphBidirectional, in_edges_1) {
+    Graph g(Graph::bidirectional);
+    Graph::vertex_descriptor vdA = add_vertex(g);
+    Graph::vertex_descriptor vdB = add_vertex(g);
+    Graph::vertex_descriptor vdC = add_vertex(g);
+    Graph::edge_descriptor edAC = add_edge(vdA, vdC, g).first;
+    Graph::edge_descriptor edBC = add_edge(vdB, vdC, g).first;
+    add_edge(vdA, vdC, g);
+
+    std::pair<Graph::in_edge_iterator, Graph::in_edge_iterator> p = in_edges(vdC, g);
+    ASSERT_EQ(edAC, *p.first);
+    ++p.first;
+    ASSERT_EQ(edBC, *p.first);
+    ++p.first;
+    ASSERT_TRUE(p.first == p.second);
+
+    p = in_edges(vdA, g);
+    ASSERT_TRUE(p.first == p.second);
+}
+TEST(TestGraphBidirectional, in_degree_1) {
+    Graph g(Graph::bidirectional);
+    Graph::vertex_descriptor vdA = add_vertex(g);
+    Graph::vertex_descriptor vdB = add_vertex(g);
+    add_edge(vdA, vdB, g);
+    add_edge(vdB, vdB, g);
+
+    ASSERT_EQ(0, in_degree(vdA, g));
+    ASSERT_EQ(2, in_degree(vdB, g));
+
+    std::pair<Graph::inv_adjacency_iterator, Graph::inv_adjacency_iterator> p = inv_adjacent_vertices(vdB, g);
+    ASSERT_EQ(vdA, *p.first);
+    ++p.first;
+    ASSERT_EQ(vdB, *p.first);
+    ++p.first;
+    ASSERT_TRUE(p.first == p.second);
+}
+TEST(TestGraphBidirectional, inv_adjacent_vertices_1) {
+    typedef boost::adjacency_list<boost::setS, boost::vecS, boost::bidirectionalS> boost_graph;
+    Graph       g(Graph::bidirectional);
+    boost_graph b;
+    for(int i = 0; i < 200; ++i) {
+        add_vertex(g);
+        add_vertex(b);
+    }
+    std::vector< std::pair<Graph::vertex_descriptor, Graph::vertex_descriptor> > v;
+    unsigned int x = 5;
+    for(int i = 0; i < 2000; ++i) {
+        x = x * 1103515245 + 12345;
+        Graph::vertex_descriptor s = (x >> 8) % 200;
+        x = x * 1103515245 + 12345;
+        v.push_back(std::make_pair(s, Graph::vertex_descriptor((x >> 8) % 200)));
+        add_edge(v.back().first, v.back().second, b);
+    }
+    add_edges(v.begin(), v.end(), g);
+
+    for(int t = 0; t < 200; ++t) {
+        ASSERT_EQ(in_degree(t, b), in_degree(t, g));
+        std::vector<Graph::vertex_descriptor> expected;
+        std::vector<Graph::vertex_descriptor> actual;
+        boost_graph::inv_adjacency_iterator bb, be;
+        for(boost::tie(bb, be) = inv_adjacent_vertices(t, b); bb != be; ++bb)
+            expected.push_back(*bb);
+        std::pair<Graph::inv_adjacency_iterator, Graph::inv_adjacency_iterator> p = inv_adjacent_vertices(t, g);
+        for(; p.first != p.second; ++p.first)
+            actual.push_back(*p.first);
+        std::sort(expected.begin(), expected.end());
+        std::sort(actual.begin(), actual.end());
+        ASSERT_TRUE(expected == actual);
+
+        std::pair<Graph::in_edge_iterator, Graph::in_edge_iterator> q = in_edges(t, g);
+        for(; q.first != q.second; ++q.first)
+            ASSERT_EQ(t, target(*q.first, g));
+    }
+}
+
+// ---------------
+// TestGraphRemove
+// ---------------
+
+TEST(TestGraphRemove, remove_edge_1) {
+    Graph g;
+    Graph::vertex_descriptor vdA = add_vertex(g);
+    Graph::vertex_descriptor vdB = add_vertex(g);
+    Graph::vertex_descriptor vdC = add_vertex(g);
+    Graph::edge_descriptor edAB = add_edge(vdA, vdB, g).first;
+    Graph::edge_descriptor edAC = add_edge(vdA, vdC, g).first;
+    Graph::edge_descriptor edBC = add_edge(vdB, vdC, g).first;
+
+    remove_edge(vdA, vdB, g);
+    remove_edge(vdC, vdA, g);
+    ASSERT_EQ(2, num_edges(g));
+    ASSERT_FALSE(edge(vdA, vdB, g).second);
+    ASSERT_EQ(edAC, edge(vdA, vdC, g).first);
+    ASSERT_EQ(vdB, source(edBC, g));
+
+    std::pair<Graph::adjacency_iterator, Graph::adjacency_iterator> a = adjacent_vertices(vdA, g);
+    ASSERT_EQ(vdC, *a.first);
+    ++a.first;
+    ASSERT_TRUE(a.first == a.second);
+
+    std::pair<Graph::edge_iterator, Graph::edge_iterator> e = edges(g);
+    ASSERT_EQ(edAC, *e.first);
+    ++e.first;
+    ASSERT_EQ(edBC, *e.first);
+    ++e.first;
+    ASSERT_TRUE(e.first == e.second);
+
+    std::pair<Graph::edge_descriptor, bool> p = add_edge(vdA, vdB, g);
+    ASSERT_TRUE(p.second);
+    ASSERT_NE(edAB, p.first);
+    ASSERT_EQ(3, num_edges(g));
+}
+TEST(TestGraphRemove, remove_edge_2) {
+    Graph g(Graph::bidirectional);
+    Graph::vertex_descriptor vdHub = add_vertex(g);
+    for(int i = 1; i <= 100; ++i)
+        add_edge(vdHub, add_vertex(g), g);
+    for(int i = 1; i <= 100; i += 2)
+        remove_edge(edge(vdHub, i, g).first, g);
+
+    ASSERT_EQ(50, num_edges(g));
+    for(int i = 1; i <= 100; ++i) {
+        ASSERT_EQ(i % 2 == 0, edge(vdHub, i, g).second);
+        ASSERT_EQ(i % 2 == 0 ? 1 : 0, in_degree(i, g));
+    }
+    ASSERT_TRUE(add_edge(vdHub, 1, g).second);
+    ASSERT_FALSE(add_edge(vdHub, 2, g).second);
+}
+TEST(TestGraphRemove, remove_vertex_1) {
+    Graph g;
+    Graph::vertex_descriptor vdA = add_vertex(g);
+    Graph::vertex_descriptor vdB = add_vertex(g);
+    Graph::vertex_descriptor vdC = add_vertex(g);
+    add_edge(vdA, vdB, g);
+    add_edge(vdB, vdC, g);
+    add_edge(vdC, vdA, g);
+    add_edge(vdC, vdB, g);
+
+    remove_vertex(vdB, g);
+    ASSERT_EQ(2, num_vertices(g));
+    ASSERT_EQ(1, num_edges(g));
+    ASSERT_TRUE(edge(vdC, vdA, g).second);
+
+    std::pair<Graph::vertex_iterator, Graph::vertex_iterator> v = vertices(g);
+    ASSERT_EQ(vdA, *v.first);
+    ++v.first;
+    ASSERT_EQ(vdC, *v.first);
+    ++v.first;
+    ASSERT_TRUE(v.first == v.second);
+
+    std::vector<Graph::vertex_descriptor> order;
+    topological_sort(g, std::back_inserter(order));
+    ASSERT_EQ(2, order.size());
+    ASSERT_EQ(vdA, order[0]);
+}
+TEST(TestGraphRemove, clear_vertex_1) {
+    Graph g(Graph::bidirectional);
+    Graph::vertex_descriptor vdA = add_vertex(g);
+    Graph::vertex_descriptor vdB = add_vertex(g);
+    add_edge(vdA, vdB, g);
+    add_edge(vdB, vdA, g);
+    add_edge(vdB, vdB, g);
+
+    clear_vertex(vdB, g);
+    ASSERT_EQ(2, num_vertices(g));
+    ASSERT_EQ(0, num_edges(g));
+    ASSERT_EQ(0, in_degree(vdA, g));
+    ASSERT_TRUE(edges(g).first == edges(g).second);
+    ASSERT_TRUE(in_edges(vdB, g).first == in_edges(vdB, g).second);
+}
+TEST(TestGraphRemove, remove_vertex_2) {
+    // vertices added after a removal are live and can be removed in turn
+    Graph g;
+    for(int i = 0; i < 3; ++i)
+        add_vertex(g);
+    remove_vertex(0, g);
+    for(int i = 0; i < 200; ++i)
+        add_vertex(g);
+    ASSERT_EQ(202, num_vertices(g));
+    remove_vertex(150, g);
+    ASSERT_EQ(201, num_vertices(g));
+
+    std::size_t n = 0;
+    std::pair<Graph::vertex_iterator, Graph::vertex_iterator> p = vertices(g);
+    for(; p.first != p.second; ++p.first) {
+        ASSERT_NE(0, *p.first);
+        ASSERT_NE(150, *p.first);
+        ++n;
+    }
+    ASSERT_EQ(201, n);
+    add_edge(202, 1, g);
+    compact(g);
+    ASSERT_EQ(201, num_vertices(g));
+    ASSERT_TRUE(edge(200, 0, g).second);
+}
+TEST(TestGraphRemove, remove_edge_hub) {
+    // the hub index points at row slots, which sort_adjacency moves
+    Graph g(Graph::bidirectional);
+    for(int i = 0; i < 101; ++i)
+        add_vertex(g);
+    for(int i = 100; i > 0; --i)
+        add_edge(0, i, g);
+    sort_adjacency(g);
+    for(int i = 2; i <= 100; i += 2)
+        remove_edge(0, i, g);
+    ASSERT_EQ(50, num_edges(g));
+    ASSERT_EQ(0, in_degree(2, g));
+    for(int i = 1; i <= 100; ++i) {
+        std::pair<Graph::edge_descriptor, bool> p = edge(0, i, g);
+        ASSERT_EQ(i % 2 == 1, p.second);
+        if(p.second) {
+            ASSERT_EQ(i, target(p.first, g));
+        }
+    }
+    ASSERT_TRUE(add_edge(0, 2, g).second);
+    remove_edge(edge(0, 3, g).first, g);
+    ASSERT_TRUE(edge(0, 2, g).second);
+    ASSERT_FALSE(edge(0, 3, g).second);
+    ASSERT_EQ(0, in_degree(3, g));
+}
+TEST(TestGraphRemove, compact_1) {
+    Graph g(Graph::bidirectional);
+    for(int i = 0; i < 6; ++i)
+        add_vertex(g);
+    for(int i = 0; i < 6; ++i)
+        for(int j = 0; j < 6; ++j)
+            add_edge(i, j, g);
+    remove_vertex(1, g);
+    remove_vertex(4, g);
+    remove_edge(0, 0, g);
+
+    compact(g);
+    ASSERT_EQ(4, num_vertices(g));
+    ASSERT_EQ(15, num_edges(g));
+    ASSERT_FALSE(edge(0, 0, g).second);
+    ASSERT_EQ(0, edge(0, 1, g).first);
+    ASSERT_EQ(1, target(0, g));
+    ASSERT_EQ(3, target(2, g));
+
+    std::pair<Graph::edge_iterator, Graph::edge_iterator> p = edges(g);
+    for(Graph::edge_descriptor ed = 0; p.first != p.second; ++p.first, ++ed) {
+        ASSERT_EQ(ed, *p.first);
+        ASSERT_EQ(ed, edge(source(ed, g), target(ed, g), g).first);
+    }
+    ASSERT_EQ(4, in_degree(1, g));
+    ASSERT_EQ(3, in_degree(0, g));
+}
+TEST(TestGraphRemove, compact_2) {
+    Graph g;
+    Graph::vertex_descriptor vdHub = add_vertex(g);
+    for(int i = 1; i <= 100; ++i)
+        add_edge(vdHub, add_vertex(g), g);
+    remove_vertex(50, g);
+    compact(g);
+
+    ASSERT_EQ(100, num_vertices(g));
+    ASSERT_EQ(99, num_edges(g));
+    for(int i = 1; i < 100; ++i)
+        ASSERT_EQ(i - 1, edge(vdHub, i, g).first);
+    ASSERT_FALSE(edge(vdHub, 100, g).second);
+
+    CompactGraph c = freeze(g);
+    ASSERT_EQ(99, num_edges(c));
+}
+
+// -------------
+// TestGraphSlim
+// -------------
+
+TEST(TestGraphSlim, remove_vertex_1) {
+    slim_graph g(slim_graph::bidirectional);
+    for(int i = 0; i < 5; ++i)
+        add_vertex(g);
+    for(int i = 0; i < 5; ++i)
+        for(int j = 0; j < 5; ++j)
+            if(i != j)
+                add_edge(i, j, g);
+    remove_vertex(2, g);
+
+    ASSERT_EQ(4, num_vertices(g));
+    ASSERT_EQ(12, num_edges(g));
+    ASSERT_EQ(3, in_degree(0, g));
+    std::pair<slim_graph::in_edge_iterator, slim_graph::in_edge_iterator> p = in_edges(4, g);
+    for(; p.first != p.second; ++p.first) {
+        ASSERT_EQ(4, target(*p.first, g));
+        ASSERT_NE(2, source(*p.first, g));
+        ASSERT_EQ(*p.first, edge(source(*p.first, g), 4, g).first);
+    }
+
+    compact(g);
+    ASSERT_EQ(4, num_vertices(g));
+    ASSERT_EQ(12, num_edges(g));
+    std::pair<slim_graph::edge_iterator, slim_graph::edge_iterator> q = edges(g);
+    std::vector<std::uint32_t> numbers;
+    for(; q.first != q.second; ++q.first) {
+        ASSERT_EQ(*q.first, edge(source(*q.first, g), target(*q.first, g), g).first);
+        numbers.push_back((*q.first).edge_no);
+    }
+    std::sort(numbers.begin(), numbers.end());
+    for(std::uint32_t i = 0; i < numbers.size(); ++i)
+        ASSERT_EQ(i, numbers[i]);
+}
+
+TEST(TestGraphSlim, clear_vertex_1) {
+    slim_graph g;
+    for(int i = 0; i < 40; ++i)
+        add_vertex(g);
+    for(int i = 1; i < 40; ++i) {
+        add_edge(0, i, g);
+        add_edge(i, 0, g);
+    }
+    slim_graph::edge_descriptor ed = edge(0, 7, g).first;
+    remove_edge(ed, g);
+    ASSERT_FALSE(edge(0, 7, g).second);
+    ASSERT_EQ(77, num_edges(g));
+
+    clear_vertex(0, g);
+    ASSERT_EQ(40, num_vertices(g));
+    ASSERT_EQ(0, num_edges(g));
+    ASSERT_TRUE(edges(g).first == edges(g).second);
+    add_edge(0, 7, g);
+    ASSERT_EQ(1, num_edges(g));
+    ASSERT_EQ(0, source(*edges(g).first, g));
+}
+
+TEST(TestGraphSlim, freeze_1) {
+    Graph g;
+    slim_graph s;
+    for(int i = 0; i < 50; ++i) {
+        add_vertex(g);
+        add_vertex(s);
+    }
+    unsigned x = 1;
+    for(int i = 0; i < 500; ++i) {
+        x = x * 1103515245 + 12345;
+        add_edge((x >> 8) % 50, (x >> 16) % 50, g);
+        add_edge((x >> 8) % 50, (x >> 16) % 50, s);
+    }
+    remove_vertex(3, g);
+    remove_vertex(3, s);
+
+    CompactGraph a = freeze(g);
+    CompactGraph b = freeze(s);
+    ASSERT_EQ(num_vertices(a), num_vertices(b));
+    ASSERT_EQ(num_edges(a), num_edges(b));
+    std::pair<CompactGraph::edge_iterator, CompactGraph::edge_iterator> p = edges(a);
+    for(; p.first != p.second; ++p.first) {
+        ASSERT_EQ(source(*p.first, a), source(*p.first, b));
+        ASSERT_EQ(target(*p.first, a), target(*p.first, b));
+    }
+}
+
+// --------------
+// TestGraphStats
+// --------------
+
+TEST(TestGraphStats, memory_usage_1) {
+    Graph      g(Graph::bidirectional);
+    slim_graph s;
+    graph_memory empty = memory_usage(g);
+    ASSERT_EQ(0, empty.total());
+
+    for(int i = 0; i < 100; ++i) {
+        add_vertex(g);
+        add_vertex(s);
+    }
+    for(int i = 1; i < 100; ++i) {
+        add_edge(0, i, g);
+        add_edge(0, i, s);
+    }
+    graph_memory m = memory_usage(g);
+    ASSERT_TRUE(m.adjacency >= 99 * 2 * sizeof(std::size_t) + 100 * sizeof(std::vector<int>));
+    ASSERT_TRUE(m.in_edges  >= 99 * 2 * sizeof(std::size_t));
+    ASSERT_TRUE(m.edge_list >= 99 * 2 * sizeof(std::size_t));
+    ASSERT_TRUE(m.hub_index >= 99 * 2 * sizeof(std::size_t));
+    ASSERT_EQ(0, m.removed);
+    ASSERT_EQ(m.adjacency + m.in_edges + m.edge_list + m.hub_index, m.total());
+
+    graph_memory n = memory_usage(s);
+    ASSERT_EQ(0, n.in_edges);
+    ASSERT_EQ(0, n.edge_list);
+    ASSERT_TRUE(n.adjacency < m.adjacency);
+    remove_vertex(5, s);
+    ASSERT_TRUE(memory_usage(s).removed >= 100 / 8);
+}
+TEST(TestGraphStats, degree_histogram_1) {
+    Graph g;
+    for(int i = 0; i < 10; ++i)
+        add_vertex(g);
+    for(int i = 1; i < 10; ++i)
+        add_edge(0, i, g);
+    add_edge(1, 2, g);
+    add_edge(2, 1, g);
+    add_edge(2, 3, g);
+    add_edge(3, 3, g);
+
+    // degrees 9, 1, 2, 1 and six 0s
+    std::vector<std::size_t> h = degree_histogram(g);
+    ASSERT_EQ(5, h.size());
+    ASSERT_EQ(6, h[0]);
+    ASSERT_EQ(2, h[1]);
+    ASSERT_EQ(1, h[2]);
+    ASSERT_EQ(0, h[3]);
+    ASSERT_EQ(1, h[4]);
+
+    remove_edge(0, 9, g);
+    ASSERT_TRUE(h == degree_histogram(g));
+    remove_edge(0, 8, g);
+    ASSERT_EQ(1, degree_histogram(g)[3]);
+    ASSERT_TRUE(degree_histogram(freeze(g)) == degree_histogram(g));
+}
+#ifdef GRAPH_STATS
+TEST(TestGraphStats, stats_1) {
+    Graph g;
+    for(int i = 0; i < 40; ++i)
+        add_vertex(g);
+    reset_stats(g);
+    for(int i = 0; i < 3; ++i)
+        add_edge(0, i, g);
+    add_edge(0, 1, g);
+    ASSERT_EQ(4, stats(g)[graph_stats::add_edge_calls]);
+    ASSERT_EQ(0 + 1 + 2 + 2, stats(g)[graph_stats::add_edge_probes]);
+    ASSERT_EQ(0, stats(g)[graph_stats::edge_calls]);
+
+    edge(0, 2, g);
+    edge(0, 7, g);
+    ASSERT_EQ(2, stats(g)[graph_stats::edge_calls]);
+    ASSERT_EQ(3 + 3, stats(g)[graph_stats::edge_probes]);
+    ASSERT_EQ(3.0, stats(g).probes_per_call(graph_stats::edge_calls));
+
+    // a hub answers in one probe
+    for(int i = 3; i < 40; ++i)
+        add_edge(0, i, g);
+    reset_stats(g);
+    edge(0, 39, g);
+    ASSERT_EQ(1, stats(g)[graph_stats::edge_probes]);
+
+    Graph h;
+    add_vertex(h);
+    for(int i = 0; i < 1000; ++i)
+        add_edge(0, add_vertex(h), h);
+    ASSERT_TRUE(stats(h)[graph_stats::reallocations] > 0);
+    ASSERT_TRUE(stats(h)[graph_stats::bytes_copied] > 1000 * sizeof(std::size_t));
+    Graph copy(h);
+    ASSERT_EQ(stats(h)[graph_stats::reallocations], stats(copy)[graph_stats::reallocations]);
+}
+#endif
+
+// -------------------
+// TestGraphConcurrent
+// -------------------
+
+TEST(TestGraphConcurrent, finish_1) {
+    concurrent_builder<> b;
+    Graph g;
+    for(int i = 0; i < 40; ++i)
+        ASSERT_EQ(add_vertex(g), add_vertex(b));
+    for(int i = 0; i < 40; ++i) {
+        ASSERT_TRUE(add_edge(0, i, g) == add_edge(0, i, b));
+        ASSERT_TRUE(add_edge(i, (i * 7) % 40, g) == add_edge(i, (i * 7) % 40, b));
+    }
+    ASSERT_EQ(num_edges(g), num_edges(b));
+
+    Graph h = finish(b);
+    ASSERT_EQ(0, num_vertices(b));
+    ASSERT_EQ(0, num_edges(b));
+    ASSERT_EQ(num_vertices(g), num_vertices(h));
+    ASSERT_EQ(num_edges(g), num_edges(h));
+    std::pair<Graph::edge_iterator, Graph::edge_iterator> p = edges(g);
+    for(; p.first != p.second; ++p.first) {
+        ASSERT_EQ(source(*p.first, g), source(*p.first, h));
+        ASSERT_EQ(target(*p.first, g), target(*p.first, h));
+        ASSERT_TRUE(edge(source(*p.first, g), target(*p.first, g), h) == std::make_pair(*p.first, true));
+    }
+    ASSERT_FALSE(edge(1, 0, h).second);
+}
+
+TEST(TestGraphConcurrent, add_edge_1) {
+    concurrent_builder<> b;
+    const int threads = 8;
+    const int per     = 200;
+    std::vector<std::thread> producers;
+    for(int t = 0; t < threads; ++t) {
+        producers.push_back(std::thread([&b] () {
+            for(int i = 0; i < per; ++i)
+                add_vertex(b);
+        }));
+    }
+    for(int t = 0; t < threads; ++t)
+        producers[t].join();
+    producers.clear();
+    ASSERT_EQ(threads * per, num_vertices(b));
+
+    // every thread adds the same edges, so most calls find an edge already there
+    const int n = threads * per;
+    for(int t = 0; t < threads; ++t) {
+        producers.push_back(std::thread([&b, t] () {
+            for(int i = 0; i < n; ++i) {
+                const int u = (i + t * 37) % n;
+                add_edge(u, (u * 13 + 1) % n, b);
+                add_edge(u % 3, u, b);
+            }
+        }));
+    }
+    for(int t = 0; t < threads; ++t)
+        producers[t].join();
+
+    Graph g = finish(b);
+    ASSERT_EQ(n, num_vertices(g));
+    std::vector<bool> seen(num_edges(g));
+    std::pair<Graph::edge_iterator, Graph::edge_iterator> p = edges(g);
+    for(; p.first != p.second; ++p.first) {
+        ASSERT_TRUE(*p.first < seen.size());
+        ASSERT_FALSE(seen[*p.first]);
+        seen[*p.first] = true;
+        ASSERT_TRUE(edge(source(*p.first, g), target(*p.first, g), g) == std::make_pair(*p.first, true));
+    }
+    for(int u = 0; u < n; ++u) {
+        ASSERT_TRUE(edge(u, (u * 13 + 1) % n, g).second);
+        ASSERT_TRUE(edge(u % 3, u, g).second);
+    }
+    ASSERT_EQ(0, std::count(seen.begin(), seen.end(), false));
+}
+
+TEST(TestGraphConcurrent, add_edge_2) {
+    concurrent_builder<std::uint32_t, false> b(slim_graph::bidirectional);
+    const int n = 300;
+    for(int i = 0; i < n; ++i)
+        add_vertex(b);
+    std::vector<std::thread> producers;
+    for(int t = 0; t < 4; ++t) {
+        producers.push_back(std::thread([&b, t] () {
+            for(int i = t; i < n; i += 4) {
+                add_edge(0, i, b);
+                add_edge(i, 0, b);
+            }
+        }));
+    }
+    for(int t = 0; t < 4; ++t)
+        producers[t].join();
+    std::pair<slim_graph::edge_descriptor, bool> p = add_edge(0, 5, b);
+    ASSERT_FALSE(p.second);
+    ASSERT_EQ(5, p.first.target);
+
+    slim_graph g = finish(b);
+    ASSERT_EQ(2 * n - 1, num_edges(g));
+    int out = 0;
+    std::pair<slim_graph::adjacency_iterator, slim_graph::adjacency_iterator> a = adjacent_vertices(0, g);
+    for(; a.first != a.second; ++a.first)
+        ++out;
+    ASSERT_EQ(n, out);
+    ASSERT_EQ(n, in_degree(0, g));
+    ASSERT_EQ(1, in_degree(n - 1, g));
+    ASSERT_TRUE(edge(0, n - 1, g).second);
+    ASSERT_TRUE(edge(n - 1, 0, g).second);
+    ASSERT_FALSE(edge(1, 2, g).second);
+    ASSERT_TRUE(p.first == edge(0, 5, g).first);
+}
+
+// ----------------
+// TestGraphReorder
+// ----------------
+
+TEST(TestGraphReorder, degree_descending_1) {
+    Graph g;
+    for(int i = 0; i < 50; ++i)
+        add_vertex(g);
+    for(int i = 0; i < 50; ++i) {
+        for(int j = 0; j < i % 7; ++j)
+            add_edge(i, (i * 11 + j) % 50, g);
+    }
+    edge_property_map<Graph, int> weight(g);
+    std::pair<Graph::edge_iterator, Graph::edge_iterator> p = edges(g);
+    for(; p.first != p.second; ++p.first)
+        weight[*p.first] = source(*p.first, g) * 100 + target(*p.first, g);
+
+    reordering<Graph, std::size_t> r = reorder(g, degree_descending);
+    ASSERT_EQ(num_vertices(g), num_vertices(r.graph));
+    ASSERT_EQ(num_edges(g), num_edges(r.graph));
+    std::vector<std::size_t> degree(50, 0);
+    for(p = edges(r.graph); p.first != p.second; ++p.first) {
+        ++degree[source(*p.first, r.graph)];
+        ++degree[target(*p.first, r.graph)];
+    }
+    for(int v = 1; v < 50; ++v)
+        ASSERT_TRUE(degree[v - 1] >= degree[v]);
+
+    // one pass moves the weights, and every edge keeps its endpoints
+    edge_property_map<Graph, int> moved(r.graph);
+    for(p = edges(g); p.first != p.second; ++p.first)
+        moved[r.edge_map[*p.first]] = weight[*p.first];
+    for(p = edges(g); p.first != p.second; ++p.first) {
+        const std::size_t e = r.edge_map[*p.first];
+        ASSERT_EQ(r.vertex_map[source(*p.first, g)], source(e, r.graph));
+        ASSERT_EQ(r.vertex_map[target(*p.first, g)], target(e, r.graph));
+        ASSERT_TRUE(edge(source(e, r.graph), target(e, r.graph), r.graph) == std::make_pair(e, true));
+        ASSERT_EQ(weight[*p.first], moved[e]);
+    }
+}
+
+TEST(TestGraphReorder, reverse_cuthill_mckee_1) {
+    // a path and a cycle, both labeled far from their order
+    Graph g;
+    const int n = 64;
+    for(int i = 0; i < 2 * n; ++i)
+        add_vertex(g);
+    for(int i = 0; i + 1 < n; ++i)
+        add_edge((i * 37) % n, ((i + 1) * 37) % n, g);
+    for(int i = 0; i < n; ++i)
+        add_edge(n + (i * 29) % n, n + ((i + 1) % n * 29) % n, g);
+
+    reordering<Graph, std::size_t> rcm = reorder(g, reverse_cuthill_mckee);
+    reordering<Graph, std::size_t> bfs = reorder(g, breadth_first);
+    std::size_t rcm_bandwidth = 0;
+    std::size_t bfs_bandwidth = 0;
+    std::pair<Graph::edge_iterator, Graph::edge_iterator> p = edges(g);
+    for(; p.first != p.second; ++p.first) {
+        const std::size_t u = rcm.vertex_map[source(*p.first, g)];
+        const std::size_t v = rcm.vertex_map[target(*p.first, g)];
+        rcm_bandwidth = std::max(rcm_bandwidth, u > v ? u - v : v - u);
+        const std::size_t x = bfs.vertex_map[source(*p.first, g)];
+        const std::size_t y = bfs.vertex_map[target(*p.first, g)];
+        bfs_bandwidth = std::max(bfs_bandwidth, x > y ? x - y : y - x);
+    }
+    ASSERT_EQ(2, rcm_bandwidth);
+    ASSERT_EQ(2, bfs_bandwidth);
+
+    // BFS starts at vertex 0; RCM starts at a degree 1 end of the path and reverses
+    ASSERT_EQ(0, bfs.vertex_map[0]);
+    ASSERT_EQ(1, bfs.vertex_map[37]);
+    ASSERT_EQ(2 * n - 1, rcm.vertex_map[0]);
+    ASSERT_EQ(2 * n - 2, rcm.vertex_map[37]);
+    ASSERT_EQ(num_edges(g), num_edges(bfs.graph));
+}
+
+TEST(TestGraphReorder, reorder_removed_1) {
+    slim_graph g(slim_graph::bidirectional);
+    for(int i = 0; i < 40; ++i)
+        add_vertex(g);
+    for(int i = 1; i < 40; ++i) {
+        add_edge(i, 0, g);
+        add_edge(i, (i + 1) % 40, g);
+    }
+    remove_vertex(7, g);
+    remove_edge(20, 0, g);
+
+    reordering<slim_graph, std::uint32_t> r = reorder(g, degree_descending);
+    ASSERT_EQ(39, num_vertices(r.graph));
+    ASSERT_EQ(num_edges(g), num_edges(r.graph));
+    ASSERT_EQ(std::numeric_limits<std::uint32_t>::max(), r.vertex_map[7]);
+    ASSERT_EQ(0, r.vertex_map[0]);
+    ASSERT_EQ(37, in_degree(0, r.graph));
+    ASSERT_FALSE(edge(r.vertex_map[20], 0, r.graph).second);
+    std::pair<slim_graph::edge_iterator, slim_graph::edge_iterator> p = edges(g);
+    for(; p.first != p.second; ++p.first) {
+        std::pair<slim_graph::edge_descriptor, bool> q = edge(r.vertex_map[source(*p.first, g)], r.vertex_map[target(*p.first, g)], r.graph);
+        ASSERT_TRUE(q.second);
+        ASSERT_EQ(r.edge_map[edge_index(*p.first, g)], edge_index(q.first, r.graph));
+    }
+}
+
+// ------------------
+// TestGraphTriangles
+// ------------------
+
+TYPED_TEST(TestGraph, triangle_count_1) {
+    ALL_OF_IT
+
+    // K5 with every edge both ways, a self loop and a pendant path
+    graph_type g;
+    for(int i = 0; i < 8; ++i)
+        add_vertex(g);
+    for(int i = 0; i < 5; ++i) {
+        for(int j = 0; j < 5; ++j) {
+            if(i != j)
+                add_edge(i, j, g);
+        }
+    }
+    add_edge(3, 3, g);
+    add_edge(4, 5, g);
+    add_edge(6, 5, g);
+    add_edge(7, 6, g);
+    ASSERT_EQ(10, triangle_count(g));
+    add_edge(6, 4, g);
+    ASSERT_EQ(11, triangle_count(g));
+
+    ASSERT_EQ(3, common_neighbors(0, 1, g));
+    ASSERT_EQ(1, common_neighbors(4, 6, g));
+    ASSERT_EQ(0, common_neighbors(5, 7, g));
+}
+
+TEST(TestGraphTriangles, triangle_count_1) {
+    // brute force over every vertex triple of a random graph
+    Graph g;
+    const int n = 120;
+    for(int i = 0; i < n; ++i)
+        add_vertex(g);
+    std::uint64_t state = 12345;
+    for(int i = 0; i < 2000; ++i) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        add_edge((state >> 33) % n, (state >> 13) % n, g);
+    }
+    std::vector< std::vector<bool> > adjacent(n, std::vector<bool>(n, false));
+    std::pair<Graph::edge_iterator, Graph::edge_iterator> p = edges(g);
+    for(; p.first != p.second; ++p.first) {
+        adjacent[source(*p.first, g)][target(*p.first, g)] = true;
+        adjacent[target(*p.first, g)][source(*p.first, g)] = true;
+    }
+    std::size_t expected = 0;
+    for(int u = 0; u < n; ++u) {
+        for(int v = u + 1; v < n; ++v) {
+            for(int w = v + 1; w < n; ++w)
+                expected += adjacent[u][v] && adjacent[v][w] && adjacent[u][w];
+        }
+    }
+    ASSERT_EQ(expected, triangle_count(g));
+    ASSERT_EQ(expected, triangle_count(freeze(g)));
+
+    sort_adjacency(g);
+    for(int u = 0; u < n; ++u) {
+        std::pair<Graph::adjacency_iterator, Graph::adjacency_iterator> a = adjacent_vertices(u, g);
+        std::vector<std::size_t> row;
+        for(; a.first != a.second; ++a.first)
+            row.push_back(*a.first);
+        ASSERT_TRUE(std::is_sorted(row.begin(), row.end()));
+        for(int v = 0; v < n; v += 7) {
+            std::size_t common = 0;
+            for(int w = 0; w < n; ++w)
+                common += edge(u, w, g).second && edge(v, w, g).second;
+            ASSERT_EQ(common, common_neighbors(u, v, g));
+        }
+    }
+    ASSERT_EQ(expected, triangle_count(g));
+    ASSERT_EQ(expected, graph_detail::count_triangles<std::size_t>(graph_detail::out_csr(g)));
+}
+
+TEST(TestGraphTriangles, intersect_1) {
+    std::uint64_t state = 99;
+    for(int trial = 0; trial < 200; ++trial) {
+        std::vector<std::uint32_t> a;
+        std::vector<std::uint32_t> b;
+        const std::uint32_t range = 8 + trial * 3;
+        for(std::uint32_t x = 0; x < range; ++x) {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+            if((state >> 60) < 7)
+                a.push_back(x);
+            if(((state >> 50) & 15) < 5)
+                b.push_back(x);
+        }
+        const std::size_t expected = graph_detail::intersect_scalar(a.data(), a.size(), b.data(), b.size());
+        std::vector<std::uint32_t> both;
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(both));
+        ASSERT_EQ(both.size(), expected);
+        ASSERT_EQ(expected, graph_detail::intersect(a.data(), a.size(), b.data(), b.size()));
+        ASSERT_EQ(expected, graph_detail::intersect_galloping(a.data(), a.size(), b.data(), b.size()));
+        ASSERT_EQ(expected, graph_detail::select_intersect()(b.data(), b.size(), a.data(), a.size()));
+#ifdef GRAPH_X86_KERNELS
+        ASSERT_EQ(expected, graph_detail::intersect_sse(a.data(), a.size(), b.data(), b.size()));
+        if(__builtin_cpu_supports("avx2")) {
+            ASSERT_EQ(expected, graph_detail::intersect_avx2(a.data(), a.size(), b.data(), b.size()));
+        }
+#endif
+    }
+}
+
+TEST(TestGraphTriangles, intersect_2) {
+    // the 64-bit fallback for descriptors past 2^32
+    const std::size_t high = std::size_t(1) << 40;
+    std::vector<std::size_t> a;
+    std::vector<std::size_t> b;
+    for(std::size_t i = 0; i < 100; ++i) {
+        a.push_back(high + 2 * i);
+        b.push_back(high + 3 * i);
+    }
+    ASSERT_EQ(34, graph_detail::intersect(a.data(), a.size(), b.data(), b.size()));
+    ASSERT_EQ(1, graph_detail::intersect(a.data(), 1, b.data(), b.size()));
+
+    std::vector<std::uint32_t> narrow;
+    CompactGraph c;
+    add_vertex(c);
+    add_vertex(c);
+    add_edge(0, 1, c);
+    ASSERT_TRUE(graph_detail::sorted_targets(0, c, narrow));
+    ASSERT_EQ(1, narrow.size());
+    std::vector<std::uint8_t> tiny;
+    for(int i = 0; i < 300; ++i)
+        add_vertex(c);
+    add_edge(0, 299, c);
+    ASSERT_FALSE(graph_detail::sorted_targets(0, c, tiny));
+}
+
+// -------------------
+// TestGraphComponents
+// -------------------
+
+/**
+ * @returns true if a and b put the same vertices together, whatever the labels
+ */
+bool same_partition (const std::vector<std::size_t>& a, const std::vector<std::size_t>& b) {
+    if(a.size() != b.size())
+        return false;
+    std::vector<std::size_t> ab(a.size() + 1, a.size());
+    std::vector<std::size_t> ba(b.size() + 1, b.size());
+    for(std::size_t v = 0; v < a.size(); ++v) {
+        if(ab[a[v]] == a.size())
+            ab[a[v]] = b[v];
+        if(ba[b[v]] == b.size())
+            ba[b[v]] = a[v];
+        if(ab[a[v]] != b[v] || ba[b[v]] != a[v])
+            return false;
+    }
+    return true;
+}
+
+TYPED_TEST(TestGraph, strong_components_1) {
+    ALL_OF_IT
+
+    // a 3-cycle feeding a 2-cycle, a self loop, a tail and an isolated vertex
+    graph_type g;
+    for(int i = 0; i < 8; ++i)
+        add_vertex(g);
+    add_edge(0, 1, g);
+    add_edge(1, 2, g);
+    add_edge(2, 0, g);
+    add_edge(2, 3, g);
+    add_edge(3, 4, g);
+    add_edge(4, 3, g);
+    add_edge(5, 5, g);
+    add_edge(5, 0, g);
+    add_edge(4, 6, g);
+
+    std::vector<std::size_t> component;
+    ASSERT_EQ(5, strong_components(g, component));
+    ASSERT_EQ(8, component.size());
+    ASSERT_EQ(component[0], component[1]);
+    ASSERT_EQ(component[0], component[2]);
+    ASSERT_EQ(component[3], component[4]);
+    ASSERT_NE(component[0], component[3]);
+    ASSERT_EQ(0, component[0]);
+    ASSERT_EQ(4, component[7]);
+
+    ASSERT_EQ(2, connected_components(g, component));
+    ASSERT_EQ(0, component[6]);
+    ASSERT_EQ(1, component[7]);
+}
+
+TEST(TestGraphComponents, strong_components_1) {
+    // cycles of many sizes chained together, plus random edges, against boost
+    typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS> boost_graph;
+    for(int seed = 1; seed <= 5; ++seed) {
+        const int   n = 3000;
+        Graph       g;
+        boost_graph b(n);
+        for(int i = 0; i < n; ++i)
+            add_vertex(g);
+        std::uint64_t state = seed;
+        for(int start = 0; start < n; ) {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+            const int size = std::min<int>(1 + (state >> 33) % 40, n - start);
+            for(int i = 0; i + 1 < size; ++i)
+                add_edge(start + i, start + i + 1, g);
+            if(state >> 63)
+                add_edge(start + size - 1, start, g);
+            if(start + size < n)
+                add_edge(start, start + size, g);
+            start += size;
+        }
+        for(int i = 0; i < n / (seed * 2); ++i) {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+            add_edge((state >> 33) % n, (state >> 13) % n, g);
+        }
+        std::pair<Graph::edge_iterator, Graph::edge_iterator> p = edges(g);
+        for(; p.first != p.second; ++p.first)
+            boost::add_edge(source(*p.first, g), target(*p.first, g), b);
+
+        std::vector<std::size_t> expected(n);
+        const std::size_t count = boost::strong_components(b, &expected[0]);
+        std::vector<std::size_t> component;
+        ASSERT_EQ(count, strong_components(g, component));
+        ASSERT_TRUE(same_partition(expected, component));
+        ASSERT_EQ(count, strong_components(freeze(g), component));
+        ASSERT_TRUE(same_partition(expected, component));
+    }
+}
+
+TEST(TestGraphComponents, connected_components_1) {
+    // random sparse graphs against boost on the undirected copy; holes from removed vertices
+    typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS> boost_graph;
+    const int   n = 5000;
+    Graph       g;
+    boost_graph b(n);
+    for(int i = 0; i < n; ++i)
+        add_vertex(g);
+    std::uint64_t state = 7;
+    for(int i = 0; i < n * 9 / 10; ++i) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        add_edge((state >> 33) % n, (state >> 13) % n, g);
+    }
+    std::pair<Graph::edge_iterator, Graph::edge_iterator> p = edges(g);
+    for(; p.first != p.second; ++p.first)
+        boost::add_edge(source(*p.first, g), target(*p.first, g), b);
+
+    std::vector<int> expected(n);
+    const std::size_t count = boost::connected_components(b, &expected[0]);
+    std::vector<std::size_t> component;
+    ASSERT_EQ(count, connected_components(g, component));
+    ASSERT_TRUE(same_partition(std::vector<std::size_t>(expected.begin(), expected.end()), component));
+
+    clear_vertex(10, g);
+    remove_vertex(10, g);
+    const std::size_t left = connected_components(g, component);
+    ASSERT_EQ(std::numeric_limits<std::size_t>::max(), component[10]);
+    ASSERT_TRUE(left >= count - 1);
+    std::vector<std::size_t> strong;
+    ASSERT_TRUE(strong_components(g, strong) >= left);
+    ASSERT_EQ(std::numeric_limits<std::size_t>::max(), strong[10]);
+}
+
+// -----------------
+// TestGraphSnapshot
+// -----------------
+
+TEST(TestGraphSnapshot, snapshot_1) {
+    versioned_graph<> g;
+    Graph             h;
+    for(int i = 0; i < 6; ++i) {
+        ASSERT_EQ(add_vertex(h), add_vertex(g));
+    }
+    for(int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(add_edge(i, i + 1, h) == add_edge(i, i + 1, g));
+    }
+    ASSERT_FALSE(add_edge(2, 3, g).second);
+
+    graph_snapshot<> s = snapshot(g);
+    add_vertex(g);
+    add_edge(5, 6, g);
+    add_edge(0, 3, g);
+    add_edge(0, 6, g);
+
+    ASSERT_EQ(6, num_vertices(s));
+    ASSERT_EQ(5, num_edges(s));
+    ASSERT_EQ(7, num_vertices(g));
+    ASSERT_EQ(8, num_edges(g));
+    std::pair<graph_snapshot<>::adjacency_iterator, graph_snapshot<>::adjacency_iterator> a = adjacent_vertices(0, s);
+    ASSERT_TRUE(a.first != a.second);
+    ASSERT_EQ(1, *a.first);
+    ++a.first;
+    ASSERT_TRUE(a.first == a.second);
+    ASSERT_FALSE(edge(0, 3, s).second);
+    ASSERT_TRUE(edge(0, 3, snapshot(g)).second);
+    ASSERT_EQ(3, edge(3, 4, s).first);
+    ASSERT_EQ(3, source(3, s));
+    ASSERT_EQ(4, target(3, s));
+
+    // the library's algorithms read a snapshot like any other graph
+    std::vector<std::size_t> parent;
+    std::vector<std::size_t> distance;
+    std::vector<std::size_t> expected;
+    breadth_first_search(s, 0, parent, distance);
+    breadth_first_search(h, 0, parent, expected);
+    ASSERT_TRUE(distance == expected);
+    breadth_first_search(snapshot(g), 0, parent, distance);
+    ASSERT_EQ(1, distance[3]);
+    ASSERT_EQ(1, connected_components(snapshot(g), distance));
+
+    graph_snapshot<> empty;
+    ASSERT_EQ(0, num_vertices(empty));
+    ASSERT_TRUE(vertices(empty).first == vertices(empty).second);
+}
+
+TEST(TestGraphSnapshot, snapshot_2) {
+    // a hub past the writer's index threshold, in a slim graph
+    versioned_graph<std::uint32_t> g;
+    for(int i = 0; i < 300; ++i)
+        add_vertex(g);
+    for(int i = 0; i < 300; ++i)
+        ASSERT_TRUE(add_edge(0, i, g).second);
+    graph_snapshot<std::uint32_t> s = snapshot(g);
+    for(int i = 0; i < 300; ++i) {
+        ASSERT_FALSE(add_edge(0, i, g).second);
+        ASSERT_EQ(i, add_edge(0, i, g).first);
+        add_edge(i, 0, g);
+    }
+    ASSERT_EQ(300, num_edges(s));
+    ASSERT_EQ(599, num_edges(g));
+    int seen = 0;
+    std::pair<graph_snapshot<std::uint32_t>::adjacency_iterator, graph_snapshot<std::uint32_t>::adjacency_iterator> a = adjacent_vertices(0, s);
+    for(; a.first != a.second; ++a.first)
+        ASSERT_EQ(seen++, *a.first);
+    ASSERT_EQ(300, seen);
+    std::vector<std::size_t> component;
+    ASSERT_EQ(300, strong_components(s, component));
+    ASSERT_EQ(1, strong_components(snapshot(g), component));
+}
+
+TEST(TestGraphSnapshot, snapshot_3) {
+    // readers check snapshots while a writer keeps adding
+    versioned_graph<> g;
+    const int n = 2000;
+    std::atomic<bool> done(false);
+    std::atomic<bool> failed(false);
+    std::atomic<int>  checked(0);
+    std::vector<std::thread> readers;
+    for(int t = 0; t < 3; ++t) {
+        readers.push_back(std::thread([&] () {
+            while(!done.load() && !failed.load()) {
+                graph_snapshot<> s = snapshot(g);
+                std::size_t out = 0;
+                std::pair<graph_snapshot<>::vertex_iterator, graph_snapshot<>::vertex_iterator> v = vertices(s);
+                for(; v.first != v.second; ++v.first) {
+                    std::pair<graph_snapshot<>::adjacency_iterator, graph_snapshot<>::adjacency_iterator> a = adjacent_vertices(*v.first, s);
+                    for(; a.first != a.second; ++a.first) {
+                        if(*a.first >= num_vertices(s) || !edge(*v.first, *a.first, s).second)
+                            failed.store(true);
+                        ++out;
+                    }
+                }
+                std::pair<graph_snapshot<>::edge_iterator, graph_snapshot<>::edge_iterator> e = edges(s);
+                for(; e.first != e.second; ++e.first) {
+                    if(edge(source(*e.first, s), target(*e.first, s), s) != std::make_pair(*e.first, true))
+                        failed.store(true);
+                }
+                if(out != num_edges(s))
+                    failed.store(true);
+                ++checked;
+            }
+        }));
+    }
+    for(int i = 0; i < n; ++i) {
+        add_vertex(g);
+        add_edge(i, i / 2, g);
+        add_edge(i / 3, i, g);
+        add_edge(0, i, g);
+    }
+    while(checked.load() < 3 && !failed.load())
+        std::this_thread::yield();
+    done.store(true);
+    for(int t = 0; t < 3; ++t)
+        readers[t].join();
+    ASSERT_FALSE(failed.load());
+
+    graph_snapshot<> s = snapshot(g);
+    ASSERT_EQ(n, num_vertices(s));
+    ASSERT_EQ(num_edges(g), num_edges(s));
+    ASSERT_TRUE(edge(0, n - 1, s).second);
+}